@@ -37,7 +37,7 @@ int main(void) {
     t0.join();
     t1.join();
 
-    if (se::Thread::encode() && smt::sat == se::Thread::encoders().solver.check()) {
+    if (se::Thread::encode() && smt::sat == se::Thread::encoders().check()) {
       return 1;
     }
   } while (slicer.next_slice());
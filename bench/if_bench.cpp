@@ -21,7 +21,7 @@ int main(void) {
 
     se::Thread::error(!(a == 'B' || a == 'A'));
 
-    if (se::Thread::encode() && smt::sat == se::Thread::encoders().solver.check()) {
+    if (se::Thread::encode() && smt::sat == se::Thread::encoders().check()) {
       return 1;
     }
   } while (slicer.next_slice());
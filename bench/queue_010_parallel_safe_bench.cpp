@@ -0,0 +1,128 @@
+// Adapted from the SV-COMP'13 benchmark:
+//   https://svn.sosy-lab.org/software/sv-benchmarks/trunk/c/pthread/queue_ok_safe.c
+
+#include "libse.h"
+#include "concurrent/mutex.h"
+#include "concurrent/workers.h"
+
+using namespace se::ops;
+
+#define N	(10)
+
+#define EMPTY	(1)
+#define FALSE	(0)
+#define TRUE	(1)
+
+se::Slicer slicer(se::MAX_SLICE_FREQ);
+
+typedef struct {
+  se::SharedVar<int[N]> element;
+  se::SharedVar<size_t> head;
+  se::SharedVar<size_t> tail;
+  se::SharedVar<int> amount;
+} QType;
+
+se::SharedVar<int[N]> stored_elements;
+
+se::SharedVar<int> enqueue_flag = TRUE;
+se::SharedVar<int> dequeue_flag = FALSE;
+
+se::Mutex mutex;
+QType queue;
+
+void init(QType *q) {
+  q->head = static_cast<size_t>(0);
+  q->tail = static_cast<size_t>(0);
+  q->amount = 0;
+}
+
+se::LocalVar<int> empty(QType *q) {
+  se::SharedVar<int> status = 0;
+  if (slicer.begin_then_branch(__COUNTER__, q->head == q->tail)) {
+    status = EMPTY;
+  }
+  slicer.end_branch(__COUNTER__);
+  return status;
+}
+
+void enqueue(QType *q, se::LocalVar<int> x) {
+  q->element[q->tail] = x;
+  q->amount = q->amount + 1;
+  if (slicer.begin_then_branch(__COUNTER__, q->tail == static_cast<size_t>(N))) {
+    q->tail = static_cast<size_t>(1);
+  }
+  if (slicer.begin_else_branch(__COUNTER__)) {
+    q->tail = q->tail + static_cast<size_t>(1);
+  }
+  slicer.end_branch(__COUNTER__);
+}
+
+se::LocalVar<int> dequeue(QType *q) {
+  se::LocalVar<int> x;
+
+  x = q->element[q->head];
+  q->amount = q->amount - 1;
+  if (slicer.begin_then_branch(__COUNTER__, q->head == static_cast<size_t>(N))) {
+    q->head = static_cast<size_t>(1);
+  }
+  if (slicer.begin_else_branch(__COUNTER__)) {
+    q->head = q->head + static_cast<size_t>(1);
+  }
+  slicer.end_branch(__COUNTER__);
+
+  return x;
+}
+
+void f1() {
+  se::LocalVar<int> v;
+
+  mutex.lock();
+  if (slicer.begin_then_branch(__COUNTER__, enqueue_flag == TRUE)) {
+    for (int i = 0; i < N; i = i + 1) {
+      v = se::any<int>();
+
+      enqueue(&queue, v);
+      stored_elements[i] = v;
+    }
+
+    enqueue_flag = FALSE;
+    dequeue_flag = TRUE;
+  }
+  slicer.end_branch(__COUNTER__);
+  mutex.unlock();
+}
+
+void f2() {
+  mutex.lock();
+  if (slicer.begin_then_branch(__COUNTER__, dequeue_flag == TRUE)) {
+    for (int i = 0; i < N; i = i + 1) {
+      if (slicer.begin_then_branch(__COUNTER__, !(empty(&queue) == EMPTY))) {
+        se::LocalVar<int> stored_element;
+        stored_element = stored_elements[i];
+        se::Thread::error(!(dequeue(&queue) == stored_element));
+      }
+      slicer.end_branch(__COUNTER__);
+    }
+
+    dequeue_flag = FALSE;
+    enqueue_flag = TRUE;
+  }
+  slicer.end_branch(__COUNTER__);
+  mutex.unlock();
+}
+
+int main(void) {
+  slicer.begin_slice_loop();
+  se::SliceWorkers workers(slicer, 4);
+  return smt::sat == workers.run([]() -> smt::CheckResult {
+    init(&queue);
+
+    se::Thread t1(f1);
+    se::Thread t2(f2);
+
+    if (!slicer.owns_slice() || !se::Thread::encode()) {
+      return smt::unsat;
+    }
+    return se::Thread::encoders().check();
+  }) ? 1 : 0;
+}
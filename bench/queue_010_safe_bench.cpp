@@ -118,7 +118,7 @@ int main(void) {
     se::Thread t1(f1);
     se::Thread t2(f2);
 
-    if (se::Thread::encode() && smt::sat == se::Thread::encoders().solver.check()) {
+    if (se::Thread::encode() && smt::sat == se::Thread::encoders().check()) {
       return 1;
     }
   } while (slicer.next_slice());
@@ -120,7 +120,7 @@ int main(void) {
     se::Thread t1(f1);
     se::Thread t2(f2);
 
-    if (se::Thread::encode() && smt::sat == se::Thread::encoders().solver.check()) {
+    if (se::Thread::encode() && smt::sat == se::Thread::encoders().check()) {
       return 0;
     }
   } while (slicer.next_slice());
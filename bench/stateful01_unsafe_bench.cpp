@@ -43,7 +43,7 @@ int main(void) {
 
     se::Thread::error(i == 16 && j == 5);
 
-    if (se::Thread::encode() && smt::sat == se::Thread::encoders().solver.check()) {
+    if (se::Thread::encode() && smt::sat == se::Thread::encoders().check()) {
       return 0;
     }
   } while (slicer.next_slice());
@@ -0,0 +1,40 @@
+// Identical worker threads that are spawned from the same recording,
+// see EncoderOptions::break_symmetry
+
+#include "libse.h"
+
+using namespace se::ops;
+
+#define N 6
+
+se::Slicer slicer;
+se::SharedVar<int> counter = 0;
+
+void worker() {
+  counter = counter + 1;
+}
+
+int main(void) {
+  slicer.begin_slice_loop();
+  do {
+    se::Thread::encoders().reset();
+
+    std::vector<se::Thread> workers;
+    workers.reserve(N);
+    for (int k = 0; k < N; k++) {
+      workers.emplace_back(se::cached_recording, worker);
+    }
+
+    for (se::Thread& thread : workers) {
+      thread.join();
+    }
+
+    se::Thread::error(counter == 0 || N < counter);
+
+    if (se::Thread::encode() && smt::sat == se::Thread::encoders().check()) {
+      return 1;
+    }
+  } while (slicer.next_slice());
+
+  return 0;
+}
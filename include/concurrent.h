@@ -15,8 +15,11 @@
 #include "concurrent/instr.h"
 #include "concurrent/encoder_c0.h"
 #include "concurrent/thread.h"
+#include "concurrent/session.h"
 #include "concurrent/var.h"
+#include "concurrent/summary.h"
 #include "concurrent/slicer.h"
+#include "concurrent/assumption_slicer.h"
 
 namespace se {
 
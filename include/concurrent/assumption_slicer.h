@@ -0,0 +1,278 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_ASSUMPTION_SLICER_H_
+#define LIBSE_CONCURRENT_ASSUMPTION_SLICER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <forward_list>
+
+#include "concurrent/slicer.h"
+
+namespace se {
+
+/// Slices a single recording of a concurrent program with selector literals
+
+/// Unlike Slicer, an AssumptionSlicer always executes both branches of every
+/// conditional block. Therefore, the concurrent program is recorded and
+/// encoded exactly once. Each branch location is associated with a Boolean
+/// selector literal whose value determines which of the two branches a slice
+/// takes: if the selector is true, then the branch condition must hold;
+/// otherwise, it must not hold. A slice is a truth assignment to all
+/// selector literals.
+///
+/// The slices are enumerated in the order of a binary-reflected Gray code so
+/// that consecutive slices differ in exactly one branch location. Each slice
+/// is checked inside its own solver scope on top of the same encoding.
+///
+/// Every unsatisfiable slice is shrunk to a minimal set of branch decisions
+/// that suffice for unsatisfiability. All later slices that agree with such
+/// a set are skipped without calling the solver. Since every attempt to drop
+/// a decision calls the solver, shrinking stops as soon as it has made as
+/// many solver calls as there are slices left to enumerate.
+///
+/// Example:
+///
+///      AssumptionSlicer slicer;
+///      if (slicer.begin_then_branch(__COUNTER__, c == '?')) {
+///        c = 'A';
+///      }
+///      if (slicer.begin_else_branch(__COUNTER__)) {
+///        c = 'B';
+///      }
+///      slicer.end_branch(__COUNTER__);
+///      ...
+///      Threads::end_main_thread(encoders);
+///      if (smt::sat == slicer.check(encoders)) { ... }
+class AssumptionSlicer {
+private:
+  typedef std::shared_ptr<ReadInstr<bool>> ConditionPtr;
+
+  // Branch condition that must be equal to the location's selector literal
+  // whenever the path condition leading to the branch is satisfied
+  struct Choice {
+    ConditionPtr path_condition_ptr;
+    ConditionPtr condition_ptr;
+  };
+
+  typedef std::map<Location, std::forward_list<Choice>> ChoiceMap;
+  ChoiceMap m_choice_map;
+  unsigned long long m_slice_count;
+  unsigned long long m_slice;
+
+  // Set of slices that agree with `value` on every bit in `mask`
+  struct Cube {
+    unsigned long long mask;
+    unsigned long long value;
+  };
+
+  const bool m_prune;
+  std::vector<Cube> m_blocked_cubes;
+  unsigned long long m_pruned_count;
+  unsigned long long m_core_check_count;
+
+  static smt::Bool selector(Location loc) {
+    return smt::any<smt::Bool>("slice_" + std::to_string(loc));
+  }
+
+  void encode_choices(Encoders& encoders) const {
+    const ReadInstrEncoder read_encoder;
+    for (ChoiceMap::const_reference choice_map_value : m_choice_map) {
+      const smt::Bool selector_expr(selector(choice_map_value.first));
+      for (const Choice& choice : choice_map_value.second) {
+        const smt::UnsafeTerm condition_expr(
+          choice.condition_ptr->encode(read_encoder, encoders));
+
+        if (choice.path_condition_ptr) {
+          encoders.solver.unsafe_add(smt::implies(
+            choice.path_condition_ptr->encode(read_encoder, encoders),
+            selector_expr == condition_expr));
+        } else {
+          encoders.solver.unsafe_add(selector_expr == condition_expr);
+        }
+      }
+    }
+  }
+
+  // Asserts the selector literals of the given slice that are in the mask
+  void add_slice(unsigned long long mask, unsigned long long slice,
+    Encoders& encoders) const {
+
+    unsigned long long bit = 1;
+    for (ChoiceMap::const_reference choice_map_value : m_choice_map) {
+      if (mask & bit) {
+        const smt::Bool selector_expr(selector(choice_map_value.first));
+        if (slice & bit) {
+          encoders.solver.add(selector_expr);
+        } else {
+          encoders.solver.add(not selector_expr);
+        }
+      }
+      bit <<= 1;
+    }
+  }
+
+  smt::CheckResult check_slice(unsigned long long mask,
+    unsigned long long slice, Encoders& encoders) const {
+
+    encoders.add_deferred_axioms();
+    encoders.solver.push();
+    add_slice(mask, slice, encoders);
+    const smt::CheckResult result = encoders.solver.check();
+    encoders.solver.pop();
+    return result;
+  }
+
+  bool is_blocked(unsigned long long slice) const {
+    for (const Cube& cube : m_blocked_cubes) {
+      if ((slice & cube.mask) == cube.value) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Shrinks the selector literals of an unsatisfiable slice to a subset
+  // that is still unsatisfiable and from which no literal can be removed,
+  // and blocks all slices that contain this subset. Shrinking stops early
+  // once it has cost as many solver calls as it could save, i.e. the number
+  // of slices that are left to enumerate.
+  void block(unsigned long long slice, unsigned long long remaining_count,
+    Encoders& encoders) {
+
+    const unsigned long long all_mask = (1ULL << m_choice_map.size()) - 1;
+    unsigned long long mask = all_mask;
+    unsigned long long check_count = 0;
+    for (unsigned long long bit = 1; (bit & all_mask) &&
+         check_count < remaining_count; bit <<= 1) {
+      check_count++;
+      if (smt::unsat == check_slice(mask & ~bit, slice, encoders)) {
+        mask &= ~bit;
+      }
+    }
+    m_core_check_count += check_count;
+
+    const Cube cube = {mask, slice & mask};
+    m_blocked_cubes.push_back(cube);
+  }
+
+public:
+  /// If prune is true, unsatisfiable slices block all the slices that agree
+  /// with them on a minimal unsatisfiable subset of their selector literals
+  AssumptionSlicer(bool prune = true) :
+    m_choice_map(),
+    m_slice_count(0),
+    m_slice(0),
+    m_prune(prune),
+    m_blocked_cubes(),
+    m_pruned_count(0),
+    m_core_check_count(0) {}
+
+  /// Number of slices that have been checked by the solver
+
+  /// The solver calls that shrink unsatisfiable slices are not included,
+  /// see core_check_count().
+  unsigned long long slice_count() const {
+    return m_slice_count;
+  }
+
+  /// Number of solver calls that have shrunk unsatisfiable slices
+  unsigned long long core_check_count() const {
+    return m_core_check_count;
+  }
+
+  /// Number of slices that have been skipped without calling the solver
+  unsigned long long pruned_count() const {
+    return m_pruned_count;
+  }
+
+  /// Number of recorded branch locations
+  size_t location_count() const {
+    return m_choice_map.size();
+  }
+
+  /// Gray code of the last checked slice
+
+  /// The k-th least significant bit corresponds to the k-th smallest branch
+  /// location. If the bit is set, the slice takes the "then" branch.
+  unsigned long long slice() const {
+    return m_slice;
+  }
+
+  /// Begin conditional block
+
+  /// This member function must be called exactly once prior to calling
+  /// end_branch(Location).
+  ///
+  /// \returns always true
+  bool begin_then_branch(Location loc, std::shared_ptr<ReadInstr<bool>> condition_ptr) {
+    assert(nullptr != condition_ptr);
+
+    const Choice choice = {ThisThread::path_condition_ptr(), condition_ptr};
+    m_choice_map[loc].push_front(choice);
+
+    ThisThread::begin_then(condition_ptr);
+    return true;
+  }
+
+  /// Begin optional block
+
+  /// \returns always true
+  bool begin_else_branch(Location loc) {
+    ThisThread::begin_else();
+    return true;
+  }
+
+  /// Demarcate the end of a conditional "then" and an optional "else" branch
+  void end_branch(Location loc) {
+    ThisThread::end_branch();
+  }
+
+  /// Check every slice until one of them is satisfiable
+
+  /// \pre the recorded threads have been encoded with the given encoders
+  ///
+  /// \returns smt::sat if and only if some slice is satisfiable, smt::unsat
+  ///          if all slices are unsatisfiable, and smt::unknown otherwise
+  smt::CheckResult check(Encoders& encoders) {
+    // one bit per branch location
+    assert(m_choice_map.size() < 64);
+
+    encode_choices(encoders);
+
+    const unsigned long long slice_end = 1ULL << m_choice_map.size();
+    smt::CheckResult result = smt::unsat;
+    for (unsigned long long i = 0; i < slice_end; i++) {
+      const unsigned long long slice = i ^ (i >> 1);
+      if (is_blocked(slice)) {
+        m_pruned_count++;
+        continue;
+      }
+
+      m_slice = slice;
+      m_slice_count++;
+
+      const smt::CheckResult slice_result = check_slice(slice_end - 1,
+        slice, encoders);
+
+      if (smt::sat == slice_result) {
+        return smt::sat;
+      }
+
+      if (smt::unknown == slice_result) {
+        result = smt::unknown;
+      } else if (m_prune) {
+        block(slice, slice_end - 1 - i, encoders);
+      }
+    }
+
+    return result;
+  }
+};
+
+}
+
+#endif
@@ -103,6 +103,26 @@ public:
   std::shared_ptr<Block> else_block_ptr() const {
     return m_else_block_ptr;
   }
+
+  /// Append all events in the body and every inner block
+
+  /// The events in the else block are only appended if `with_else` is true.
+  /// Inner blocks are always appended together with their else blocks.
+  void filter(std::forward_list<std::shared_ptr<Event>>& event_ptrs,
+    bool with_else = true) const {
+
+    for (const std::shared_ptr<Event>& event_ptr : m_body) {
+      event_ptrs.push_front(event_ptr);
+    }
+
+    for (const std::shared_ptr<Block>& inner_block_ptr : m_inner_block_ptrs) {
+      inner_block_ptr->filter(event_ptrs);
+    }
+
+    if (with_else && m_else_block_ptr) {
+      m_else_block_ptr->filter(event_ptrs);
+    }
+  }
 };
 
 }
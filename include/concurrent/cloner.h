@@ -0,0 +1,260 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_CLONER_H_
+#define LIBSE_CONCURRENT_CLONER_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "concurrent/zone.h"
+#include "concurrent/event.h"
+#include "concurrent/instr.h"
+
+namespace se {
+
+/// Copies recorded events and read instructions with fresh identifiers
+
+/// A recording is a sequence of events whose identifiers are in the interval
+/// [begin_event_id, end_event_id) and whose shared variables were declared
+/// with zone atoms in [begin_atom, end_atom). Every event in the recording is
+/// cloned at most once, and the clone is performed by the given thread. All
+/// other events are left as they are, unless they have been \ref bind()
+/// "bound" to another event.
+///
+/// The path conditions of the recorded events are conjoined with the path
+/// condition under which the clones are recorded. Boolean instructions that
+/// are shared, such as branch conditions, are cloned once so that their
+/// clones are shared likewise.
+class EventCloner {
+private:
+  typedef std::shared_ptr<ReadInstr<bool>> ConditionPtr;
+
+  const ThreadId m_thread_id;
+
+  // nullptr if the clones are unconditional
+  const ConditionPtr m_condition_ptr;
+
+  const EventId m_begin_event_id;
+  const EventId m_end_event_id;
+  const unsigned m_begin_atom;
+  const unsigned m_end_atom;
+
+  std::unordered_map<const Event*, std::shared_ptr<Event>> m_event_ptrs;
+
+  // identifiers of cloned write events which their local read events share
+  std::unordered_map<EventId, EventId> m_event_ids;
+
+  std::unordered_map<unsigned, unsigned> m_atoms;
+  std::unordered_map<const ReadInstr<bool>*, ConditionPtr> m_instr_ptrs;
+  std::unordered_map<const ReadInstr<bool>*, ConditionPtr> m_condition_ptrs;
+
+  bool is_recorded(EventId event_id) const {
+    return m_begin_event_id <= event_id && event_id < m_end_event_id;
+  }
+
+public:
+  /// \param condition_ptr - path condition of the clones, can be nullptr
+  EventCloner(ThreadId thread_id, const ConditionPtr& condition_ptr,
+    EventId begin_event_id, EventId end_event_id,
+    unsigned begin_atom, unsigned end_atom);
+
+  EventCloner(const EventCloner&) = delete;
+
+  ThreadId thread_id() const {
+    return m_thread_id;
+  }
+
+  /// Number of events cloned so far
+  size_t clone_count() const {
+    return m_event_ptrs.size();
+  }
+
+  /// Use the given event wherever the recorded event is read
+  void bind(const std::shared_ptr<Event>& event_ptr,
+    const std::shared_ptr<Event>& clone_ptr);
+
+  /// Clone of a recorded event, or the given event otherwise
+
+  /// \pre the event is not a synchronization event
+  std::shared_ptr<Event> event_ptr(const std::shared_ptr<Event>& event_ptr);
+
+  template<typename T>
+  std::shared_ptr<ReadEvent<T>> read_event_ptr(
+    const std::shared_ptr<ReadEvent<T>>& read_event_ptr) {
+
+    return std::static_pointer_cast<ReadEvent<T>>(
+      event_ptr(std::static_pointer_cast<Event>(read_event_ptr)));
+  }
+
+  /// Zone whose atoms of the recording are replaced by fresh ones
+  Zone zone(const Zone& zone);
+
+  /// Clone of a shared read instruction
+  template<typename T>
+  std::shared_ptr<ReadInstr<T>> instr_ptr(
+    const std::shared_ptr<ReadInstr<T>>& instr_ptr) {
+
+    return instr_ptr->clone(*this);
+  }
+
+  /// Clone of a shared Boolean read instruction, or nullptr
+  ConditionPtr instr_ptr(const ConditionPtr& instr_ptr);
+
+  /// Path condition of a clone
+
+  /// \param condition_ptr - recorded path condition, can be nullptr
+  ConditionPtr condition_ptr(const ConditionPtr& condition_ptr);
+
+  template<typename T>
+  std::unique_ptr<ReadInstr<T>> clone(const LiteralReadInstr<T>& instr) {
+    const ReadInstr<T>& base = instr;
+    return std::unique_ptr<ReadInstr<T>>(new LiteralReadInstr<T>(
+      instr.literal(), condition_ptr(base.condition_ptr())));
+  }
+
+  template<typename T, size_t N>
+  std::unique_ptr<ReadInstr<T[N]>> clone(const LiteralReadInstr<T[N]>& instr) {
+    const ReadInstr<T[N]>& base = instr;
+    return std::unique_ptr<ReadInstr<T[N]>>(new LiteralReadInstr<T[N]>(
+      condition_ptr(base.condition_ptr())));
+  }
+
+  template<typename T>
+  std::unique_ptr<ReadInstr<T>> clone(const BasicReadInstr<T>& instr) {
+    return std::unique_ptr<ReadInstr<T>>(new BasicReadInstr<T>(
+      read_event_ptr(instr.event_ptr())));
+  }
+
+  template<Opcode opcode, typename U>
+  std::unique_ptr<ReadInstr<typename ReturnType<opcode, U>::result_type>>
+  clone(const UnaryReadInstr<opcode, U>& instr) {
+    typedef typename ReturnType<opcode, U>::result_type T;
+    return std::unique_ptr<ReadInstr<T>>(new UnaryReadInstr<opcode, U>(
+      instr_ptr(instr.m_operand_ptr)));
+  }
+
+  template<Opcode opcode, typename U, typename V>
+  std::unique_ptr<ReadInstr<typename ReturnType<opcode, U, V>::result_type>>
+  clone(const BinaryReadInstr<opcode, U, V>& instr) {
+    typedef typename ReturnType<opcode, U, V>::result_type T;
+    std::unique_ptr<ReadInstr<U>> loperand_ptr(instr.loperand_ref().clone(*this));
+    std::unique_ptr<ReadInstr<V>> roperand_ptr(instr.roperand_ref().clone(*this));
+    return std::unique_ptr<ReadInstr<T>>(new BinaryReadInstr<opcode, U, V>(
+      std::move(loperand_ptr), std::move(roperand_ptr)));
+  }
+
+  template<Opcode opcode, typename T>
+  std::unique_ptr<ReadInstr<T>> clone(const NaryReadInstr<opcode, T>& instr) {
+    typename NaryReadInstr<opcode, T>::OperandPtrs operand_ptrs;
+    auto operand_iter = operand_ptrs.cbefore_begin();
+    for (const std::shared_ptr<ReadInstr<T>>& operand_ptr : instr.operand_ptrs()) {
+      operand_iter = operand_ptrs.insert_after(operand_iter,
+        instr_ptr(operand_ptr));
+    }
+    return std::unique_ptr<ReadInstr<T>>(new NaryReadInstr<opcode, T>(
+      std::move(operand_ptrs), instr.size()));
+  }
+
+  template<typename T, typename U, size_t N>
+  std::unique_ptr<DerefReadInstr<T[N], U>> clone_deref(
+    const DerefReadInstr<T[N], U>& instr) {
+
+    std::unique_ptr<ReadInstr<T[N]>> memory_ptr(instr.memory_ref().clone(*this));
+    std::unique_ptr<ReadInstr<U>> offset_ptr(instr.offset_ref().clone(*this));
+    return std::unique_ptr<DerefReadInstr<T[N], U>>(
+      new DerefReadInstr<T[N], U>(std::move(memory_ptr), std::move(offset_ptr)));
+  }
+
+  template<typename T, typename U, size_t N>
+  std::unique_ptr<ReadInstr<T>> clone(const DerefReadInstr<T[N], U>& instr) {
+    return std::unique_ptr<ReadInstr<T>>(clone_deref(instr));
+  }
+
+  template<typename T>
+  std::shared_ptr<Event> clone(const ReadEvent<T>& event) {
+    const ConditionPtr clone_condition_ptr(condition_ptr(event.condition_ptr()));
+    if (event.zone().is_bottom()) {
+      // thread-local read events share the identifier of their write event
+      const auto event_id_iter = m_event_ids.find(event.event_id());
+      if (event_id_iter != m_event_ids.cend()) {
+        return std::shared_ptr<Event>(new ReadEvent<T>(event_id_iter->second,
+          m_thread_id, event.zone(), clone_condition_ptr));
+      }
+    }
+
+    return std::shared_ptr<Event>(new ReadEvent<T>(m_thread_id,
+      zone(event.zone()), clone_condition_ptr));
+  }
+
+  template<typename T>
+  std::shared_ptr<Event> clone(const DirectWriteEvent<T>& event) {
+    std::unique_ptr<ReadInstr<T>> instr_ptr(event.instr_ref().clone(*this));
+    return std::shared_ptr<Event>(new DirectWriteEvent<T>(m_thread_id,
+      zone(event.zone()), std::move(instr_ptr),
+      condition_ptr(event.condition_ptr())));
+  }
+
+  template<typename T>
+  std::shared_ptr<Event> clone(const ReadModifyWriteEvent<T>& event) {
+    std::unique_ptr<ReadInstr<T>> instr_ptr(event.instr_ref().clone(*this));
+    return std::shared_ptr<Event>(new ReadModifyWriteEvent<T>(m_thread_id,
+      zone(event.zone()), read_event_ptr(event.read_event_ptr()),
+      std::move(instr_ptr), condition_ptr(event.condition_ptr())));
+  }
+
+  template<typename T, typename U, size_t N>
+  std::shared_ptr<Event> clone(const IndirectWriteEvent<T, U, N>& event) {
+    std::unique_ptr<DerefReadInstr<T[N], U>> deref_instr_ptr(
+      clone_deref(event.deref_instr_ref()));
+    std::unique_ptr<ReadInstr<T>> instr_ptr(event.instr_ref().clone(*this));
+    return std::shared_ptr<Event>(new IndirectWriteEvent<T, U, N>(m_thread_id,
+      zone(event.zone()), std::move(deref_instr_ptr), std::move(instr_ptr),
+      condition_ptr(event.condition_ptr())));
+  }
+};
+
+#define CLONE_FN_DEF \
+  clone(EventCloner& cloner) const {\
+    return cloner.clone(*this);\
+  }
+
+template<typename T>
+std::unique_ptr<ReadInstr<T>> LiteralReadInstr<T>::CLONE_FN_DEF
+
+template<typename T, size_t N>
+std::unique_ptr<ReadInstr<T[N]>> LiteralReadInstr<T[N]>::CLONE_FN_DEF
+
+template<typename T>
+std::unique_ptr<ReadInstr<T>> BasicReadInstr<T>::CLONE_FN_DEF
+
+template<Opcode opcode, typename U>
+std::unique_ptr<ReadInstr<typename ReturnType<opcode, U>::result_type>>
+UnaryReadInstr<opcode, U>::CLONE_FN_DEF
+
+template<Opcode opcode, typename U, typename V>
+std::unique_ptr<ReadInstr<typename ReturnType<opcode, U, V>::result_type>>
+BinaryReadInstr<opcode, U, V>::CLONE_FN_DEF
+
+template<Opcode opcode, typename T>
+std::unique_ptr<ReadInstr<T>> NaryReadInstr<opcode, T>::CLONE_FN_DEF
+
+template<typename T, typename U, size_t N>
+std::unique_ptr<ReadInstr<T>> DerefReadInstr<T[N], U>::CLONE_FN_DEF
+
+template<typename T>
+std::shared_ptr<Event> ReadEvent<T>::CLONE_FN_DEF
+
+template<typename T>
+std::shared_ptr<Event> DirectWriteEvent<T>::CLONE_FN_DEF
+
+template<typename T>
+std::shared_ptr<Event> ReadModifyWriteEvent<T>::CLONE_FN_DEF
+
+template<typename T, typename U, size_t N>
+std::shared_ptr<Event> IndirectWriteEvent<T, U, N>::CLONE_FN_DEF
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_CONE_H_
+#define LIBSE_CONCURRENT_CONE_H_
+
+#include <forward_list>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "concurrent/event.h"
+#include "concurrent/instr.h"
+#include "concurrent/block.h"
+
+namespace se {
+
+/// Events that can affect the value of a property
+
+/// A dependency cone is the least set of events that contains all the read
+/// events of the properties (i.e. error and expect conditions) and that is
+/// closed under the following dependencies:
+///
+///   - a read event of a local variable depends on the write event with the
+///     same \ref Event::event_id() "event identifier";
+///   - a read event of shared memory depends on every write event whose
+///     zone overlaps with the read event's zone;
+///   - a write event depends on the read events that determine its value;
+///   - every event depends on the read events in its condition.
+///
+/// The union of the zones of all shared memory accesses in the cone is
+/// called the \ref DependencyCone::zone() "zone of the cone".
+class DependencyCone {
+private:
+  typedef std::forward_list<std::shared_ptr<Event>> EventPtrs;
+
+  // never null
+  std::unique_ptr<Zone> m_zone_ptr;
+  std::unordered_set<const Event*> m_event_set;
+
+  static void push_condition(const Event& event, EventPtrs& worklist) {
+    const std::shared_ptr<ReadInstr<bool>> condition_ptr(event.condition_ptr());
+    if (condition_ptr) {
+      condition_ptr->filter(worklist);
+    }
+  }
+
+public:
+  /// \param property_event_ptrs read events in error and expect conditions
+  /// \param event_ptrs all recorded events
+  DependencyCone(const EventPtrs& property_event_ptrs,
+    const EventPtrs& event_ptrs) :
+    m_zone_ptr(new Zone()), m_event_set() {
+
+    // thread-local write events are uniquely identified by their identifier
+    std::unordered_map<EventId, std::shared_ptr<Event>> local_write_map;
+    for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+      if (event_ptr->is_write() && event_ptr->zone().is_bottom()) {
+        local_write_map[event_ptr->event_id()] = event_ptr;
+      }
+    }
+
+    EventPtrs worklist(property_event_ptrs);
+    bool is_fixpoint = false;
+    while (!is_fixpoint) {
+      while (!worklist.empty()) {
+        const std::shared_ptr<Event> event_ptr(worklist.front());
+        worklist.pop_front();
+
+        if (!m_event_set.insert(event_ptr.get()).second) {
+          continue;
+        }
+
+        const Event& event = *event_ptr;
+        if (!event.zone().is_bottom()) {
+          m_zone_ptr.reset(new Zone(m_zone_ptr->join(event.zone())));
+        } else if (event.is_read()) {
+          const auto local_write_iter(local_write_map.find(event.event_id()));
+          if (local_write_iter != local_write_map.cend()) {
+            worklist.push_front(local_write_iter->second);
+          }
+        }
+
+        event.filter(worklist);
+        push_condition(event, worklist);
+      }
+
+      // shared write events that can be read by events in the cone
+      for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+        if (event_ptr->is_write() && m_event_set.count(event_ptr.get()) == 0 &&
+            !event_ptr->zone().meet(*m_zone_ptr).is_bottom()) {
+          worklist.push_front(event_ptr);
+        }
+      }
+
+      is_fixpoint = worklist.empty();
+    }
+  }
+
+  /// Union of all the zones of shared memory accesses in the cone
+  const Zone& zone() const {
+    return *m_zone_ptr;
+  }
+
+  /// Is the given event in the cone?
+  bool contains(const Event& event) const {
+    return m_event_set.count(&event) != 0 ||
+      !event.zone().meet(*m_zone_ptr).is_bottom();
+  }
+
+  /// Do the two cones share an event or overlapping shared memory?
+  bool overlaps(const DependencyCone& other) const {
+    if (!m_zone_ptr->meet(*other.m_zone_ptr).is_bottom()) {
+      return true;
+    }
+    for (const Event* event_ptr : m_event_set) {
+      if (other.m_event_set.count(event_ptr) != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Does the given block write to memory that can affect a property?
+
+  /// The events in the else block are only considered if `with_else` is true.
+  bool is_relevant(const Block& block, bool with_else) const {
+    EventPtrs event_ptrs;
+    block.filter(event_ptrs, with_else);
+    for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+      if (event_ptr->is_write() && contains(*event_ptr)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_CUBES_H_
+#define LIBSE_CONCURRENT_CUBES_H_
+
+#include <vector>
+
+#include "concurrent/encoder.h"
+
+namespace se {
+
+/// Checks a single encoded recording by splitting it into cubes
+
+/// The shared read events with the most candidate write events (i.e. those
+/// whose zones overlap) are "hot". Every cube fixes for each hot read event
+/// either the write event it reads from, or that it reads from none of
+/// its candidates. Hence, the cubes partition the search space.
+///
+/// The cubes are distributed among forked worker processes, each of which
+/// checks its cubes with its own copy of the solver. As soon as one cube
+/// is satisfiable, all workers are stopped.
+///
+/// Example:
+///
+///      se::CubeSplitter splitter(8);
+///      slicer.begin_slice_loop();
+///      do {
+///        se::Thread::encoders().reset();
+///        ...
+///        if (se::Thread::encode() &&
+///            smt::sat == splitter.check(se::Thread::encoders())) { ... }
+///      } while (slicer.next_slice());
+class CubeSplitter {
+private:
+  const unsigned m_worker_count;
+  const unsigned long long m_max_cube_count;
+  unsigned long long m_cube_count;
+
+  // \internal runs inside a forked child process
+  smt::CheckResult work(unsigned worker, const smt::UnsafeTerms& cubes,
+    Encoders& encoders) const;
+
+public:
+  /// \pre 0 < worker_count
+  /// \pre 0 < max_cube_count
+  CubeSplitter(unsigned worker_count, unsigned long long max_cube_count = 64);
+  CubeSplitter(const CubeSplitter&) = delete;
+
+  unsigned worker_count() const {
+    return m_worker_count;
+  }
+
+  /// Number of cubes of the last check()
+  unsigned long long cube_count() const {
+    return m_cube_count;
+  }
+
+  /// Cubes over the read-from choices of the hottest read events
+
+  /// Read events are added in order of decreasing number of candidate
+  /// write events until there would be more than `max_cube_count` cubes.
+  ///
+  /// \pre Threads::encode(encoders) has been called
+  smt::UnsafeTerms split(Encoders& encoders) const;
+
+  /// Check the encoded recording one cube after another in parallel
+
+  /// \pre Threads::encode(encoders) has been called
+  ///
+  /// \returns smt::sat if some cube is satisfiable, smt::unsat if all are
+  ///          unsatisfiable, and smt::unknown otherwise
+  smt::CheckResult check(Encoders& encoders);
+};
+
+}
+
+#endif
@@ -5,10 +5,16 @@
 #ifndef LIBSE_CONCURRENT_ENCODER_H_
 #define LIBSE_CONCURRENT_ENCODER_H_
 
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "core/op.h"
 #include "concurrent/instr.h"
+#include "concurrent/range.h"
 
 #include <smt>
 
@@ -18,62 +24,297 @@ namespace se {
 
 class Event;
 
-#ifdef __USE_BV__
-typedef smt::Bv<unsigned short> ClockSort;
-#else
-typedef smt::Int ClockSort;
-#endif
+/// Strict total order of clocks whose pairs are Boolean variables
+
+/// Every pair of distinct nodes `x < y` is represented by exactly one
+/// Boolean variable that is true if and only if `x` happens before `y`;
+/// its negation means that `y` happens before `x`. Therefore, the order is
+/// total and asymmetric by construction. Since the epoch happens before
+/// every other node, its pairs need no variables at all.
+///
+/// Transitivity is not enforced until transitivity() is called, usually
+/// once all axioms have been encoded. Only pairs that occur in the axioms
+/// have a variable, and transitivity is only asserted on the triangles of
+/// a chordal graph that contains these pairs. This suffices because an
+/// orientation of a chordal graph that is transitive on every triangle can
+/// always be extended to a strict total order of all the nodes.
+class HappensBeforeMatrix
+{
+private:
+  const std::string m_prefix;
+  std::unordered_map<std::string, unsigned> m_node_map;
+
+  // nodes that are paired with each node by a variable
+  std::vector<std::unordered_set<unsigned>> m_adjacency;
+  unsigned long long m_pair_count;
+  unsigned long long m_triangle_count;
+
+  // \pre x < y
+  smt::UnsafeTerm variable(unsigned x, unsigned y) const;
+
+public:
+  /// Node that happens before all the others
+  static constexpr unsigned s_epoch = 0;
+
+  /// \param prefix - prefix of the names of all the Boolean variables
+  HappensBeforeMatrix(const std::string& prefix);
+  HappensBeforeMatrix(const HappensBeforeMatrix&) = delete;
+
+  /// Node of the given name, which is created if it does not exist yet
+
+  /// The name `epoch` always refers to the epoch.
+  unsigned node(const std::string& name);
 
+  /// Boolean term that holds if and only if x happens before y
+  smt::UnsafeTerm happens_before(unsigned x, unsigned y);
+
+  /// Number of nodes, including the epoch
+  size_t node_count() const {
+    return m_adjacency.size();
+  }
+
+  /// Number of Boolean variables
+  unsigned long long pair_count() const {
+    return m_pair_count;
+  }
+
+  /// Number of triangles on which transitivity has been asserted
+  unsigned long long triangle_count() const {
+    return m_triangle_count;
+  }
+
+  /// Assert transitivity of all the pairs that have a variable
+
+  /// This may create variables for further pairs.
+  ///
+  /// \returns number of triangles on which transitivity has been asserted
+  unsigned long long transitivity(smt::Solver& solver);
+
+  /// Forget all nodes except the epoch
+  void reset();
+};
+
+/// Clock whose encoding is chosen by EncoderOptions::happens_before
+
+/// A clock is either a term whose theory is chosen by EncoderOptions::theory,
+/// or a node of a HappensBeforeMatrix.
 class Clock
 {
 private:
-  ClockSort m_term;
+  smt::UnsafeTerm m_term;
+
+  // nullptr unless the clock is a node of the matrix
+  HappensBeforeMatrix* m_matrix_ptr;
+  unsigned m_node;
 
 public:
-  Clock(const ClockSort& term)
-  : m_term(term) {}
+  Clock(const smt::UnsafeTerm& term)
+  : m_term(term), m_matrix_ptr(nullptr), m_node(0) {}
+
+  Clock(HappensBeforeMatrix* matrix_ptr, unsigned node)
+  : m_term(), m_matrix_ptr(matrix_ptr), m_node(node) {}
 
   Clock(const Clock& other)
-  : m_term(other.m_term) {}
+  : m_term(other.m_term),
+    m_matrix_ptr(other.m_matrix_ptr),
+    m_node(other.m_node) {}
 
   Clock(Clock&& other)
-  : m_term(std::move(other.m_term)) {}
+  : m_term(std::move(other.m_term)),
+    m_matrix_ptr(other.m_matrix_ptr),
+    m_node(other.m_node) {}
 
-  smt::Bool happens_before(
+  smt::UnsafeTerm happens_before(
     const Clock& y) const
   {
+    if (m_matrix_ptr) {
+      assert(m_matrix_ptr == y.m_matrix_ptr);
+      return m_matrix_ptr->happens_before(m_node, y.m_node);
+    }
     return m_term < y.m_term;
   }
 
-  smt::Bool simultaneous(
+  smt::UnsafeTerm simultaneous(
     const Clock& y) const
   {
+    if (m_matrix_ptr) {
+      assert(m_matrix_ptr == y.m_matrix_ptr);
+      return smt::literal<smt::Bool>(m_node == y.m_node);
+    }
     return m_term == y.m_term;
   }
 
-  smt::Bool simultaneous_or_happens_before(
+  smt::UnsafeTerm simultaneous_or_happens_before(
     const Clock& y) const
   {
+    if (m_matrix_ptr) {
+      if (m_node == y.m_node) {
+        return smt::literal<smt::Bool>(true);
+      }
+      return happens_before(y);
+    }
     return m_term <= y.m_term;
   }
 
-  const ClockSort& term() const
+  /// \pre the clock is not a node of a HappensBeforeMatrix
+  const smt::UnsafeTerm& term() const
   {
+    assert(m_matrix_ptr == nullptr);
     return m_term;
   }
 
   Clock& operator=(const Clock& other)
   {
     m_term = other.m_term;
+    m_matrix_ptr = other.m_matrix_ptr;
+    m_node = other.m_node;
     return *this;
   }
 };
 
+/// SMT solver that decides the encoding
+enum class SolverBackend { Z3, MSAT, CVC4 };
+
+/// Theory of the values of events and their clocks
+enum class Theory { INT, BV };
+
+/// Encoding of the happens-before order of events
+enum class HappensBefore {
+  /// Every event has a clock, and clocks are ordered by their values
+  CLOCKS,
+
+  /// Every pair of events has a Boolean variable, see HappensBeforeMatrix
+  MATRIX
+};
+
+/// Encoding of which write event a read event reads from
+enum class ReadFrom {
+  /// Every read event has a clock constant that equals the identifier of
+  /// the write event it reads from
+  IDENTIFIERS,
+
+  /// Every candidate pair of a write and read event has a Boolean selector
+  /// of which at most one is true per read event
+  SELECTORS
+};
+
+/// Encoding that the clocks of write events (or the read-from identifiers
+/// of read events) in the same zone atom are distinct
+enum class Distinctness {
+  /// A single `distinct` term per zone atom
+  DISTINCT,
+
+  /// `x < y or y < x` for every pair of clocks `x` and `y`
+  PAIRWISE,
+
+  /// An inverse array maps the i-th clock back to `i`, which is only
+  /// possible if the clocks are distinct
+  INJECTION,
+
+  /// Like DISTINCT, but deferred until Encoders::check() needs it
+  LAZY
+};
+
+/// Choices among equisatisfiable encodings of the same recording
+struct EncoderOptions {
+  SolverBackend backend;
+  Theory theory;
+  HappensBefore happens_before;
+  ReadFrom read_from;
+  Distinctness distinctness;
+
+  /// Assert every axiom instance on its own instead of their conjunction?
+  bool split_axioms;
+
+  /// Encode clocks as bit vectors with as few bits as the recording needs?
+
+  /// The width is determined by Threads::encode(Encoders&) just before the
+  /// clocks are encoded, see Encoders::bound_clocks().
+  bool narrow_clocks;
+
+  /// Encode values as bit vectors with as few bits as the recording needs?
+
+  /// The widths are inferred by Threads::encode(Encoders&) with a
+  /// RangeAnalysis before any value is encoded, see Encoders::bound_values().
+  /// This has no effect unless the theory is Theory::BV. Every literal that
+  /// is compared to a recorded value must be part of the recording, i.e. in
+  /// the value or condition of an event, or in an error or expect condition.
+  bool narrow_values;
+
+  /// Introduce a fresh clock at every merge point of an if/else?
+
+  /// Otherwise, the first event after a merge point happens after the last
+  /// events of both branches, which needs no extra clock at the cost of
+  /// more program order constraints.
+  bool join_clocks;
+
+  /// Defer the stack axioms of each zone atom until they are needed?
+
+  /// Threads::encode(Encoders&) then only asserts the read-from, program
+  /// order and write serialization axioms. Encoders::check() adds the
+  /// deferred axioms of one zone atom after another for as long as the
+  /// formula remains satisfiable. Since the deferred axioms only remove
+  /// behaviours, an unsatisfiable answer can stop the refinement early.
+  bool refine_axioms;
+
+  /// Order threads that have been spawned from the same recording?
+
+  /// Threads that are spawned one after another with the Thread tag
+  /// CachedRecording run the same code on the same shared variables, so
+  /// every execution can be permuted such that their first unconditional
+  /// shared memory writes happen in the order in which the threads have
+  /// been spawned. Threads::encode(Encoders&) asserts this order for all
+  /// such threads whose spawns, and joins if any, are adjacent in the same
+  /// thread and under the same path condition.
+  bool break_symmetry;
+
+  /// Largest number of context switches that Encoders::check() tries before
+  /// it falls back to the unbounded encoding, or zero to check unbounded
+
+  /// Threads::encode(Encoders&) assigns every event with a clock to one of
+  /// the contexts 0, 1, ..., context_bound, each of which is owned by a
+  /// single thread. Encoders::check() then bounds the contexts of all events
+  /// by 0, 1, ..., context_bound in turn and stops at the first satisfiable
+  /// bound, since many bugs show up after only a few context switches.
+  unsigned context_bound;
+
+  /// Z3 with the theory of bit vectors if __USE_BV__ is defined and the
+  /// theory of integers otherwise, unless overridden by the environment
+  /// variables LIBSE_SOLVER (`z3`, `msat` or `cvc4`) and LIBSE_THEORY
+  /// (`int` or `bv`). Clocks are encoded as HappensBefore::CLOCKS unless
+  /// the environment variable LIBSE_ORDER is `matrix`, read-from uses
+  /// ReadFrom::SELECTORS if LIBSE_RF is `selectors`, LIBSE_DISTINCT selects
+  /// the distinctness (`distinct`, `pairwise`, `injection` or `lazy`),
+  /// join_clocks is set
+  /// unless LIBSE_JOIN_CLOCKS is `off`, refine_axioms is set if
+  /// LIBSE_REFINE is `on`, break_symmetry is set unless LIBSE_SYMMETRY is
+  /// `off`, and context_bound is the number in LIBSE_CONTEXT_BOUND, if any.
+  EncoderOptions();
+};
+
+/// \internal Integral type of the given signedness and number of bits
+template<bool is_signed, unsigned width> struct NarrowType;
+
+template<> struct NarrowType<false, 8> { typedef uint8_t Type; };
+template<> struct NarrowType<false, 16> { typedef uint16_t Type; };
+template<> struct NarrowType<false, 32> { typedef uint32_t Type; };
+template<> struct NarrowType<true, 8> { typedef int8_t Type; };
+template<> struct NarrowType<true, 16> { typedef int16_t Type; };
+template<> struct NarrowType<true, 32> { typedef int32_t Type; };
+
 class Encoders {
+private:
+  const EncoderOptions m_options;
+
+  // never null
+  const std::unique_ptr<smt::Solver> m_solver_ptr;
+
+  static smt::Solver* make_solver(const EncoderOptions& options);
+
 public:
-  // logic must support uninterpreted functions and
-  // uses bit vectors only if __USE_BV__ is defined
-  smt::Z3Solver solver;
+  // logic must support uninterpreted functions and uses
+  // bit vectors if and only if the theory is Theory::BV
+  smt::Solver& solver;
 
 private:
   const std::string m_rf_prefix;
@@ -81,7 +322,18 @@ private:
   const std::string m_clock_prefix;
   const std::string m_join_clock_prefix;
   const std::string m_event_prefix;
-  const Clock m_epoch;
+  const std::string m_context_prefix;
+
+  // nullptr unless the clocks are encoded as HappensBefore::MATRIX
+  const std::unique_ptr<HappensBeforeMatrix> m_matrix_ptr;
+  Clock m_epoch;
+
+  // number of bits of narrowed clocks, zero if the clocks are not narrowed
+  unsigned m_clock_width;
+
+  // narrowed values and array indexes, see RangeAnalysis
+  RangeAnalysis::Widths m_value_widths;
+  RangeAnalysis::Widths m_index_widths;
 
   friend class ValueEncoder;
   friend class ReadInstrEncoder;
@@ -93,18 +345,120 @@ private:
   friend smt::UnsafeTerm IndirectWriteEvent<T, U, N>::constant(Encoders&) const;
 
   unsigned m_join_id;
+  unsigned m_inverse_id;
+
+  // axioms that are added by check() when needed
+  std::deque<smt::UnsafeTerm> m_deferred_axioms;
 
   std::string create_symbol(const Event& event) {
     return m_event_prefix + std::to_string(event.event_id());
   }
 
+  bool is_bv() const {
+    return m_options.theory == Theory::BV;
+  }
+
+  // zero if the value of the given event or literal is not narrowed
+  static unsigned lookup_width(const RangeAnalysis::Widths& widths, const void* key) {
+    const auto width_iter = widths.find(key);
+    return width_iter == widths.cend() ? 0 : width_iter->second;
+  }
+
+  // array sorts can only be created from C++ types
+  template<typename D, typename T>
+  static smt::UnsafeTerm any_array(const std::string& symbol, unsigned width) {
+    constexpr bool is_signed = std::is_signed<T>::value;
+    switch (width) {
+    case 8:
+      return smt::any<smt::Array<smt::Bv<D>,
+        smt::Bv<typename NarrowType<is_signed, 8>::Type>>>(symbol);
+    case 16:
+      return smt::any<smt::Array<smt::Bv<D>,
+        smt::Bv<typename NarrowType<is_signed, 16>::Type>>>(symbol);
+    case 32:
+      return smt::any<smt::Array<smt::Bv<D>,
+        smt::Bv<typename NarrowType<is_signed, 32>::Type>>>(symbol);
+    default:
+      return smt::any<smt::Array<smt::Bv<D>, smt::Bv<T>>>(symbol);
+    }
+  }
+
   template<typename T, size_t N>
   smt::UnsafeTerm create_array_constant(const Event& event) {
-#ifdef __USE_BV__
-    return smt::any<smt::Array<smt::Bv<size_t>, smt::Bv<T>>>(create_symbol(event));
-#else
+    if (is_bv()) {
+      const std::string symbol(create_symbol(event));
+      const unsigned value_width = lookup_width(m_value_widths, &event);
+      switch (lookup_width(m_index_widths, &event)) {
+      case 8:
+        return any_array<uint8_t, T>(symbol, value_width);
+      case 16:
+        return any_array<uint16_t, T>(symbol, value_width);
+      case 32:
+        return any_array<uint32_t, T>(symbol, value_width);
+      default:
+        return any_array<size_t, T>(symbol, value_width);
+      }
+    }
     return smt::any<smt::Array<smt::Int, smt::Int>>(create_symbol(event));
-#endif
+  }
+
+  /// Offset into the array of the given event
+  smt::UnsafeTerm index_literal(const Event& event, size_t index) const {
+    if (is_bv()) {
+      const unsigned index_width = lookup_width(m_index_widths, &event);
+      if (0 < index_width) {
+        return smt::literal(smt::bv_sort(false, index_width), index);
+      }
+      return smt::literal<smt::Bv<size_t>>(index);
+    }
+    return smt::literal<smt::Int>(index);
+  }
+
+  smt::UnsafeTerm scalar_literal(const void* key, bool value) const {
+    return smt::literal<smt::Bool>(value);
+  }
+
+  // key is the literal read instruction that determines the width
+  template<typename T, class = typename std::enable_if<
+    std::is_arithmetic<T>::value>::type>
+  smt::UnsafeTerm scalar_literal(const void* key, T value) const {
+    if (is_bv()) {
+      const unsigned value_width = lookup_width(m_value_widths, key);
+      if (0 < value_width) {
+        return smt::literal(smt::bv_sort(std::is_signed<T>::value,
+          value_width), value);
+      }
+      return smt::literal<smt::Bv<T>>(value);
+    }
+    return smt::literal<smt::Int>(value);
+  }
+
+  const smt::Sort& clock_sort() const {
+    if (0 < m_clock_width) {
+      return smt::bv_sort(false, m_clock_width);
+    }
+    if (is_bv()) {
+      return smt::internal::sort<smt::Bv<unsigned short>>();
+    }
+    return smt::internal::sort<smt::Int>();
+  }
+
+  // clock that happens before all others
+  Clock epoch() {
+    if (m_matrix_ptr) {
+      return Clock(m_matrix_ptr.get(), HappensBeforeMatrix::s_epoch);
+    }
+    return clock_literal(0);
+  }
+
+  smt::UnsafeTerm clock_literal(unsigned long long value) const {
+    if (0 < m_clock_width) {
+      return smt::literal(clock_sort(), value);
+    }
+    if (is_bv()) {
+      return smt::literal<smt::Bv<unsigned short>>(value);
+    }
+    return smt::literal<smt::Int>(value);
   }
 
   smt::UnsafeTerm constant(const ReadEvent<bool>& event) {
@@ -127,86 +481,289 @@ private:
   }
 
 public:
-  Encoders()
-#ifdef __USE_BV__
-  : solver(smt::QF_AUFBV_LOGIC),
-#else
-  : solver(smt::QF_AUFLIA_LOGIC),
-#endif
+  explicit Encoders(const EncoderOptions& options = EncoderOptions())
+  : m_options(options),
+    m_solver_ptr(make_solver(options)),
+    solver(*m_solver_ptr),
     m_rf_prefix("rf_"),
     m_sup_clock_prefix("sup-clock_"),
     m_clock_prefix("clock_"),
     m_join_clock_prefix("join-clock_"),
     m_event_prefix("event_"),
-#ifndef __USE_MATRIX
-    m_epoch(smt::literal<ClockSort>(0)),
-#endif
-    m_join_id(0) {}
+    m_context_prefix("context_"),
+    m_matrix_ptr(options.happens_before == HappensBefore::MATRIX ?
+      new HappensBeforeMatrix("happens-before_") : nullptr),
+    m_epoch(epoch()),
+    m_clock_width(0),
+    m_value_widths(),
+    m_index_widths(),
+    m_join_id(0),
+    m_inverse_id(0),
+    m_deferred_axioms() {}
 
   void reset() {
     solver.reset();
+    m_deferred_axioms.clear();
+    if (m_matrix_ptr) {
+      m_matrix_ptr->reset();
+    }
+  }
+
+  const EncoderOptions& options() const {
+    return m_options;
+  }
+
+  /// Fewest number of bits that represent every natural number up to bound
+  static unsigned bit_width(unsigned long long bound) {
+    unsigned width = 1;
+    while (width < 64 && (bound >> width) != 0) {
+      width++;
+    }
+    return width;
+  }
+
+  /// Number of bits of narrowed clocks, or zero if clocks are not narrowed
+  unsigned clock_width() const {
+    return m_clock_width;
+  }
+
+  /// Clocks that an inverse array maps back to their position
+
+  /// The i-th clock is mapped to `i` by a fresh array. This is satisfiable
+  /// if and only if all the clocks are distinct.
+  ///
+  /// \pre clocks are not narrowed, see clock_width()
+  smt::UnsafeTerm injective(const smt::UnsafeTerms& clocks) {
+    assert(m_clock_width == 0);
+
+    const std::string name("clock-inverse_" + std::to_string(m_inverse_id++));
+    smt::UnsafeTerm inverse;
+    if (is_bv()) {
+      inverse = smt::any<smt::Array<smt::Bv<unsigned short>,
+        smt::Bv<unsigned short>>>(name);
+    } else {
+      inverse = smt::any<smt::Array<smt::Int, smt::Int>>(name);
+    }
+
+    smt::UnsafeTerm expr(smt::literal<smt::Bool>(true));
+    for (size_t i = 0; i < clocks.size(); i++) {
+      expr = expr and smt::select(inverse, clocks[i]) == clock_literal(i);
+    }
+    return expr;
+  }
+
+  /// Defer an axiom until check() needs it, see EncoderOptions::refine_axioms
+  void defer(const smt::UnsafeTerm& axiom) {
+    m_deferred_axioms.push_back(axiom);
+  }
+
+  /// Number of axioms that have not been added to the solver yet
+  size_t deferred_axiom_count() const {
+    return m_deferred_axioms.size();
+  }
+
+  /// Add all deferred axioms to the solver
+
+  /// This must be called before the solver's assertions are checked under
+  /// a push() because axioms added by check() would otherwise be popped.
+  void add_deferred_axioms() {
+    for (const smt::UnsafeTerm& axiom : m_deferred_axioms) {
+      solver.unsafe_add(axiom);
+    }
+    m_deferred_axioms.clear();
+  }
+
+  /// Check the solver's assertions including those deferred by defer()
+
+  /// The deferred axioms are added one at a time until either the formula
+  /// becomes unsatisfiable or no more axioms are left.
+  ///
+  /// If EncoderOptions::context_bound is positive, the contexts are first
+  /// bounded by 0, 1, ..., context_bound, each under its own push(). Only if
+  /// none of these bounds is satisfiable are the assertions checked without
+  /// a bound.
+  smt::CheckResult check() {
+    if (0 < m_options.context_bound) {
+      // deferred axioms would otherwise be popped with the first bound
+      add_deferred_axioms();
+
+      for (unsigned bound = 0; bound <= m_options.context_bound; bound++) {
+        solver.push();
+        solver.unsafe_add(context_bound(bound));
+        const smt::CheckResult bound_result = solver.check();
+        solver.pop();
+
+        if (bound_result == smt::sat) {
+          return smt::sat;
+        }
+      }
+    }
+
+    smt::CheckResult result = solver.check();
+    while (result == smt::sat && !m_deferred_axioms.empty()) {
+      solver.unsafe_add(m_deferred_axioms.front());
+      m_deferred_axioms.pop_front();
+      result = solver.check();
+    }
+    return result;
+  }
+
+  /// Number of clocks that have been introduced by join_clocks()
+  unsigned join_clock_count() const {
+    return m_join_id;
+  }
+
+  /// Narrow the clocks to bit vectors whose values range up to the bound
+
+  /// This has no effect unless EncoderOptions::narrow_clocks is set.
+  ///
+  /// \pre the bound is at least the number of clocks and at least the
+  ///      largest identifier of an event that is read from
+  /// \pre no clock has been created since the last narrowing
+  void bound_clocks(unsigned long long bound) {
+    if (!m_options.narrow_clocks) {
+      return;
+    }
+
+    m_clock_width = bit_width(bound);
+    m_epoch = epoch();
+  }
+
+  /// Narrow the values to the bit widths inferred by the given analysis
+
+  /// This has no effect unless EncoderOptions::narrow_values is set and the
+  /// theory is Theory::BV.
+  ///
+  /// \pre RangeAnalysis::solve() has been called
+  /// \pre no value of the recording has been encoded yet
+  void bound_values(const RangeAnalysis& analysis) {
+    if (!m_options.narrow_values || !is_bv()) {
+      return;
+    }
+
+    m_value_widths = analysis.value_widths();
+    m_index_widths = analysis.index_widths();
+  }
+
+  /// Number of bits of the given event's narrowed value, or zero if the
+  /// value is not narrowed
+  unsigned value_width(const Event& event) const {
+    return lookup_width(m_value_widths, &event);
   }
 
   /// Creates a Z3 constant according to the event's \ref Event::type() "type"
   smt::UnsafeTerm constant(const Event& event) {
-#ifdef __USE_BV__
-    const smt::Sort& sort = smt::bv_sort(event.type().is_signed(), event.type().bv_size());
-    const smt::UnsafeDecl decl(create_symbol(event), sort);
-#else
+    if (is_bv()) {
+      const unsigned value_width = lookup_width(m_value_widths, &event);
+      const smt::Sort& sort = smt::bv_sort(event.type().is_signed(),
+        0 < value_width ? value_width : event.type().bv_size());
+      const smt::UnsafeDecl decl(create_symbol(event), sort);
+      return smt::constant(decl);
+    }
+
     const smt::UnsafeDecl decl(create_symbol(event), smt::internal::sort<smt::Int>());
-#endif
     return smt::constant(decl);
   }
 
+  /// Creates a free clock with the given name
+
+  /// In a HappensBeforeMatrix, the clock named `epoch` happens before all
+  /// others.
+  Clock any_clock(const std::string& name) const {
+    if (m_matrix_ptr) {
+      return Clock(m_matrix_ptr.get(), m_matrix_ptr->node(name));
+    }
+    return Clock(smt::constant(smt::UnsafeDecl(name, clock_sort())));
+  }
+
   Clock join_clocks(
     const Clock& x,
     const Clock& y)
   {
-#ifndef __USE_MATRIX__
     const std::string join_name = m_join_clock_prefix + std::to_string(m_join_id++);
-    const Clock join_clock(smt::any<ClockSort>(join_name));
-    solver.add(m_epoch.happens_before(join_clock));
-    solver.add(x.happens_before(join_clock) && y.happens_before(join_clock));
+    const Clock join_clock(any_clock(join_name));
+    solver.unsafe_add(m_epoch.happens_before(join_clock));
+    solver.unsafe_add(x.happens_before(join_clock) && y.happens_before(join_clock));
     return join_clock;
-#endif
   }
 
-  /// Equality between write event and read event applied to function `rf`
+  /// Boolean term that holds if and only if the read event reads from the
+  /// write event
 
-  /// \returns `w == rf(r)`, i.e. `r` reads from `w`
+  /// With ReadFrom::IDENTIFIERS, the term is `w == rf(r)` where `rf(r)` is
+  /// the identifier of the write event read by `r`, see rf_clock(). With
+  /// ReadFrom::SELECTORS, it is a fresh Boolean variable for the pair.
   smt::UnsafeTerm rf(const Event& write_event, const Event& read_event) {
     assert(write_event.is_write());
     assert(read_event.is_read());
 
-    return write_event.event_id() == rf_clock(read_event);
+    if (m_options.read_from == ReadFrom::SELECTORS) {
+      return smt::any<smt::Bool>(m_rf_prefix + create_symbol(write_event) +
+        "_" + create_symbol(read_event));
+    }
+
+    return clock_literal(write_event.event_id()) == rf_clock(read_event);
   }
 
-  ClockSort rf_clock(const Event& read_event) {
+  /// \pre read-from is encoded as ReadFrom::IDENTIFIERS
+  smt::UnsafeTerm rf_clock(const Event& read_event) {
     assert(read_event.is_read());
+    assert(m_options.read_from == ReadFrom::IDENTIFIERS);
 
-    return smt::any<ClockSort>(m_rf_prefix + create_symbol(read_event));
+    // write event identifiers, even if clocks are a matrix
+    return smt::constant(smt::UnsafeDecl(m_rf_prefix + create_symbol(read_event),
+      clock_sort()));
+  }
+
+  /// Context of an event, see EncoderOptions::context_bound
+  smt::UnsafeTerm context(const Event& event) {
+    return smt::constant(smt::UnsafeDecl(m_context_prefix +
+      create_symbol(event), clock_sort()));
+  }
+
+  /// Literal of a context or thread identifier with the sort of contexts
+  smt::UnsafeTerm context_literal(unsigned long long value) const {
+    return clock_literal(value);
+  }
+
+  /// Thread that owns the given context
+  smt::UnsafeTerm context_owner(unsigned context) {
+    return smt::constant(smt::UnsafeDecl(m_context_prefix + "owner_" +
+      std::to_string(context), clock_sort()));
+  }
+
+  /// Does every event have a context, see EncoderOptions::context_bound?
+  smt::UnsafeTerm has_contexts() {
+    return smt::any<smt::Bool>(m_context_prefix + "enabled");
+  }
+
+  /// Are all contexts less than or equal to the given bound?
+  smt::UnsafeTerm context_bound(unsigned bound) {
+    return smt::any<smt::Bool>(m_context_prefix + "bound_" +
+      std::to_string(bound));
   }
 
   /// Unique clock constraint for an event
   Clock clock(const Event& event) {
-#ifndef __USE_MATRIX__
-    const Clock clock(smt::any<ClockSort>(m_clock_prefix + create_symbol(event)));
-    solver.add(m_epoch.happens_before(clock));
+    const Clock clock(any_clock(m_clock_prefix + create_symbol(event)));
+    solver.unsafe_add(m_epoch.happens_before(clock));
     return clock;
-#endif
   }
 
-  void transitivity(const std::unordered_set<std::shared_ptr<Event>>& event_ptrs)
+  /// Happens-before matrix, or nullptr if clocks are HappensBefore::CLOCKS
+  const HappensBeforeMatrix* matrix_ptr() const {
+    return m_matrix_ptr.get();
+  }
+
+  /// Assert the transitivity of the happens-before order
+
+  /// This has no effect unless clocks are encoded as HappensBefore::MATRIX,
+  /// in which case it must be called after all clocks have been ordered.
+  void transitivity()
   {
-/*    for (const std::shared_ptr<Event>& x : event_ptrs) {
-      for (const std::shared_ptr<Event>& y : event_ptrs) {
-        for (const std::shared_ptr<Event>& z : event_ptrs) {
-          solver.add(smt::implies(clock(*x) <= clock(*y) and clock(*y) <= clock(*z),
-            clock(*x) <= clock(*z)));
-        }
-      }
+    if (m_matrix_ptr) {
+      m_matrix_ptr->transitivity(solver);
     }
-*/
   }
 
   /// Individual array element literal
@@ -214,29 +771,20 @@ public:
     class = typename std::enable_if<std::is_array<T>::value and 0 < N>::type>
   smt::UnsafeTerm literal(const LiteralReadInstr<T>& instr) {
 
-    typedef typename std::remove_extent<T>::type ElementType;
-    return literal(LiteralReadInstr<ElementType>(instr.element_literal()));
-  }
-
-  smt::UnsafeTerm literal(const LiteralReadInstr<bool>& instr) {
-    return smt::literal<smt::Bool>(instr.literal());
+    return scalar_literal(&instr, instr.element_literal());
   }
 
   template<typename T, class = typename std::enable_if<
     std::is_arithmetic<T>::value>::type>
   smt::UnsafeTerm literal(const LiteralReadInstr<T>& instr) {
-#if __USE_BV__
-    return smt::literal<smt::Bv<T>>(instr.literal());
-#else
-    return smt::literal<smt::Int>(instr.literal());
-#endif
+    return scalar_literal(&instr, instr.literal());
   }
 
   /// Find upper bound of `{clock(e) | e in E and clock(e) < clock(r)}`
   Clock sup_clock(const Event& read_event) {
     assert(read_event.is_read());
 
-    return Clock(smt::any<ClockSort>(m_sup_clock_prefix + create_symbol(read_event)));
+    return any_clock(m_sup_clock_prefix + create_symbol(read_event));
   }
 };
 
@@ -359,11 +907,7 @@ public:
     smt::UnsafeTerm init_expr(event.instr_ref().encode(m_read_encoder, helper));
     smt::UnsafeTerm and_expr(smt::literal<smt::Bool>(true));
     for (size_t i = 0; i < N; i++) {
-#if __USE_BV__
-      and_expr = and_expr && (smt::select(lhs_expr, smt::literal<smt::Bv<size_t>>(i)) == init_expr);
-#else
-      and_expr = and_expr && (smt::select(lhs_expr, smt::literal<smt::Int>(i)) == init_expr);
-#endif
+      and_expr = and_expr && (smt::select(lhs_expr, helper.index_literal(event, i)) == init_expr);
     }
     return and_expr;
   }
@@ -6,6 +6,8 @@
 #define LIBSE_CONCURRENT_ENCODER_C0_H_
 
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <smt>
 
 #include "concurrent/encoder.h"
@@ -288,6 +290,115 @@ private:
   typedef std::shared_ptr<Event> EventPtr;
   typedef std::unordered_set<EventPtr> EventPtrSet;
 
+  // Conjoins the axiom with the given expression, or asserts the axiom on
+  // its own if `split` is true
+  static void conjoin(smt::UnsafeTerm& expr, const smt::UnsafeTerm& axiom,
+    bool split, Encoders& encoders) {
+
+    if (split) {
+      encoders.solver.unsafe_add(axiom);
+    } else {
+      expr = expr and axiom;
+    }
+  }
+
+  // Splits the axioms as requested by EncoderOptions::split_axioms
+  static void conjoin(smt::UnsafeTerm& expr, const smt::UnsafeTerm& axiom,
+    Encoders& encoders) {
+
+    conjoin(expr, axiom, encoders.options().split_axioms, encoders);
+  }
+
+  // Clocks that are distinct as requested by EncoderOptions::distinctness,
+  // either conjoined with the given expression or deferred
+  static void conjoin_distinct(smt::UnsafeTerm& expr, smt::UnsafeTerms&& terms,
+    Encoders& encoders) {
+
+    switch (encoders.options().distinctness) {
+    case Distinctness::PAIRWISE:
+      for (size_t i = 0; i < terms.size(); i++) {
+        for (size_t j = i + 1; j < terms.size(); j++) {
+          conjoin(expr, terms[i] < terms[j] or terms[j] < terms[i], encoders);
+        }
+      }
+      return;
+
+    case Distinctness::INJECTION:
+      // array indexes and elements must have the sort of the clocks
+      if (encoders.clock_width() == 0) {
+        conjoin(expr, encoders.injective(terms), encoders);
+        return;
+      }
+      break;
+
+    case Distinctness::LAZY:
+      encoders.defer(smt::distinct(std::move(terms)));
+      return;
+
+    default:
+      break;
+    }
+
+    conjoin(expr, smt::distinct(std::move(terms)), encoders);
+  }
+
+  // Pairwise encoding that at most one of the Boolean terms holds
+  static smt::UnsafeTerm at_most_one(const smt::UnsafeTerms& terms) {
+    smt::UnsafeTerm expr(smt::literal<smt::Bool>(true));
+    for (size_t i = 0; i < terms.size(); i++) {
+      for (size_t j = i + 1; j < terms.size(); j++) {
+        expr = expr and not (terms[i] and terms[j]);
+      }
+    }
+    return expr;
+  }
+
+  // Stack axiom instances of a single zone atom
+  void stack_zone_enc(const EventPtrSet& read_event_ptrs,
+    const EventPtrSet& write_event_ptrs, bool split, smt::UnsafeTerm& fr_expr,
+    Encoders& encoders) const {
+
+    for (const EventPtr& write_event_ptr_x : write_event_ptrs) {
+      for (const EventPtr& write_event_ptr_y : write_event_ptrs) {
+        if (write_event_ptr_x == write_event_ptr_y) { continue; }
+
+        const Event& write_event_x = *write_event_ptr_x;
+        const Event& write_event_y = *write_event_ptr_y;
+
+        assert(!write_event_x.zone().is_bottom());
+        assert(!write_event_y.zone().is_bottom());
+
+        const smt::UnsafeTerm xy_order(encoders.clock(write_event_x).happens_before(encoders.clock(write_event_y)));
+        for (const EventPtr& read_event_ptr_p : read_event_ptrs) {
+          const Event& read_event_p = *read_event_ptr_p;
+          const smt::UnsafeTerm xp_schedule(encoders.rf(write_event_x, read_event_p));
+          const smt::UnsafeTerm yp_order(encoders.clock(write_event_y).happens_before(encoders.clock(read_event_p)));
+
+          smt::UnsafeTerm some_rf(smt::literal<smt::Bool>(false));
+          for (const EventPtr& read_event_ptr_q : read_event_ptrs) {
+            if (read_event_ptr_p == read_event_ptr_q) { continue; }
+
+            const Event& read_event_q = *read_event_ptr_q;
+
+            assert(!read_event_p.zone().is_bottom());
+            assert(!read_event_q.zone().is_bottom());
+
+            const smt::UnsafeTerm yq_schedule(encoders.rf(write_event_y, read_event_q));
+            const smt::UnsafeTerm qp_order(encoders.clock(read_event_q).happens_before(encoders.clock(read_event_p)));
+
+            conjoin(fr_expr, smt::implies(xy_order and xp_schedule and
+              yq_schedule, qp_order), split, encoders);
+            some_rf = some_rf or yq_schedule;
+          }
+
+          const smt::UnsafeTerm y_condition(event_condition(write_event_y, encoders));
+          conjoin(fr_expr, smt::implies(xp_schedule and xy_order and
+            yp_order and y_condition, some_rf), split, encoders);
+        }
+      }
+    }
+  }
+
 public:
   Z3OrderEncoderC0() : m_read_encoder() {}
 
@@ -302,6 +413,7 @@ public:
       const smt::UnsafeTerm read_event_condition(event_condition(read_event, encoders));
 
       smt::UnsafeTerm wr_schedules(smt::literal<smt::Bool>(false));
+      smt::UnsafeTerms wr_selectors;
       for (const EventPtr& y_ptr : relation.event_ptrs()) {
         if (y_ptr->is_read()) { continue; }
         const Event& write_event = *y_ptr;
@@ -318,15 +430,71 @@ public:
         const smt::UnsafeTerm write_event_condition(event_condition(write_event, encoders));
 
         wr_schedules = wr_schedules or wr_schedule;
-        rf_expr = rf_expr and smt::implies(wr_schedule, wr_order and
-          write_event_condition and wr_equality);
+        wr_selectors.push_back(wr_schedule);
+        conjoin(rf_expr, smt::implies(wr_schedule, wr_order and
+          write_event_condition and wr_equality), encoders);
       }
 
-      rf_expr = rf_expr and smt::implies(read_event_condition, wr_schedules);
+      conjoin(rf_expr, smt::implies(read_event_condition, wr_schedules),
+        encoders);
+
+      // unlike identifiers, selectors can hold for several write events
+      if (encoders.options().read_from == ReadFrom::SELECTORS &&
+          1 < wr_selectors.size()) {
+        conjoin(rf_expr, at_most_one(wr_selectors), encoders);
+      }
     }
     return rf_expr;
   }
 
+  /// \internal \return every read-modify-write operation reads from the
+  /// write event that immediately precedes its own write event
+
+  /// For a write event `w` that reads from `x` through its read event, every
+  /// other write event to the same memory happens before `x` or after `w`.
+  /// The write events of a conditional operation are only constrained if
+  /// their condition holds, see ReadModifyWriteEvent.
+  smt::UnsafeTerm rmw_enc(const ZoneRelation<Event>& relation, Encoders& encoders) const {
+    smt::UnsafeTerm rmw_expr(smt::literal<smt::Bool>(true));
+    for (const Zone& zone : relation.zone_atoms()) {
+      const EventPtrSet write_event_ptrs = relation.find(zone,
+        WriteEventPredicate::predicate());
+
+      for (const EventPtr& rmw_event_ptr : write_event_ptrs) {
+        const Event* const read_event_ptr = rmw_event_ptr->rmw_read_event_ptr();
+        if (!read_event_ptr) { continue; }
+
+        const Event& rmw_event = *rmw_event_ptr;
+        const Clock rmw_clock(encoders.clock(rmw_event));
+        const smt::UnsafeTerm rmw_condition(event_condition(rmw_event, encoders));
+
+        for (const EventPtr& write_event_ptr_x : write_event_ptrs) {
+          if (write_event_ptr_x == rmw_event_ptr) { continue; }
+
+          const Event& write_event_x = *write_event_ptr_x;
+          const smt::UnsafeTerm xr_schedule(encoders.rf(write_event_x,
+            *read_event_ptr));
+          const Clock x_clock(encoders.clock(write_event_x));
+
+          for (const EventPtr& write_event_ptr_y : write_event_ptrs) {
+            if (write_event_ptr_y == write_event_ptr_x ||
+                write_event_ptr_y == rmw_event_ptr) { continue; }
+
+            const Event& write_event_y = *write_event_ptr_y;
+            const Clock y_clock(encoders.clock(write_event_y));
+            const smt::UnsafeTerm y_condition(event_condition(write_event_y, encoders));
+
+            conjoin(rmw_expr, smt::implies(xr_schedule and rmw_condition and
+              y_condition, y_clock.happens_before(x_clock) or
+              rmw_clock.happens_before(y_clock)), encoders);
+          }
+        }
+      }
+    }
+
+    return rmw_expr;
+  }
+
   /// \internal \return FR axiom encoding
   smt::UnsafeTerm fr_enc(const ZoneRelation<Event>& relation, Encoders& encoders) const {
     const ZoneAtomSet& zone_atoms = relation.zone_atoms();
@@ -376,50 +544,36 @@ public:
     for (const Zone& zone : zone_atoms) {
       const std::pair<EventPtrSet, EventPtrSet> result =
         relation.partition(zone);
-      const EventPtrSet& read_event_ptrs = result.first;
-      const EventPtrSet& write_event_ptrs = result.second;
-
-      for (const EventPtr& write_event_ptr_x : write_event_ptrs) {
-        for (const EventPtr& write_event_ptr_y : write_event_ptrs) {
-          if (write_event_ptr_x == write_event_ptr_y) { continue; }
-
-          const Event& write_event_x = *write_event_ptr_x;
-          const Event& write_event_y = *write_event_ptr_y;
-
-          assert(!write_event_x.zone().is_bottom());
-          assert(!write_event_y.zone().is_bottom());
-
-          const smt::UnsafeTerm xy_order(encoders.clock(write_event_x).happens_before(encoders.clock(write_event_y)));
-          for (const EventPtr& read_event_ptr_p : read_event_ptrs) {
-            const Event& read_event_p = *read_event_ptr_p;
-            const smt::UnsafeTerm xp_schedule(encoders.rf(write_event_x, read_event_p));
-            const smt::UnsafeTerm yp_order(encoders.clock(write_event_y).happens_before(encoders.clock(read_event_p)));
-
-            smt::UnsafeTerm some_rf(smt::literal<smt::Bool>(false));
-            for (const EventPtr& read_event_ptr_q : read_event_ptrs) {
-              if (read_event_ptr_p == read_event_ptr_q) { continue; }
-
-              const Event& read_event_q = *read_event_ptr_q;
+      stack_zone_enc(result.first, result.second,
+        encoders.options().split_axioms, fr_expr, encoders);
+    }
 
-              assert(!read_event_p.zone().is_bottom());
-              assert(!read_event_q.zone().is_bottom());
+    return fr_expr;
+  }
 
-              const smt::UnsafeTerm yq_schedule(encoders.rf(write_event_y, read_event_q));
-              const smt::UnsafeTerm qp_order(encoders.clock(read_event_q).happens_before(encoders.clock(read_event_p)));
+  /// \internal Defers the stack axiom of every zone atom to Encoders::check()
 
-              fr_expr = fr_expr and
-                smt::implies(xy_order and xp_schedule and yq_schedule, qp_order);
-              some_rf = some_rf or yq_schedule;
-            }
+  /// The axioms of zone atoms with fewer instances are added first.
+  void defer_stack_enc(const ZoneRelation<Event>& relation, Encoders& encoders) const {
+    typedef std::pair<unsigned long long, smt::UnsafeTerm> SizedAxiom;
+    std::vector<SizedAxiom> axioms;
+    for (const Zone& zone : relation.zone_atoms()) {
+      const std::pair<EventPtrSet, EventPtrSet> result =
+        relation.partition(zone);
+      const unsigned long long r = result.first.size();
+      const unsigned long long w = result.second.size();
+      if (r == 0 || w < 2) { continue; }
 
-            const smt::UnsafeTerm y_condition(event_condition(write_event_y, encoders));
-            fr_expr = fr_expr and smt::implies(xp_schedule and xy_order and yp_order and y_condition, some_rf);
-          }
-        }
-      }
+      smt::UnsafeTerm zone_expr(smt::literal<smt::Bool>(true));
+      stack_zone_enc(result.first, result.second, false, zone_expr, encoders);
+      axioms.emplace_back(r * r * w * w, zone_expr);
     }
 
-    return fr_expr;
+    std::stable_sort(axioms.begin(), axioms.end(),
+      [](const SizedAxiom& x, const SizedAxiom& y) { return x.first < y.first; });
+    for (const SizedAxiom& axiom : axioms) {
+      encoders.defer(axiom.second);
+    }
   }
 
   /// \internal \return total order on pushes 
@@ -427,6 +581,12 @@ public:
     const ZoneAtomSet& zone_atoms = relation.zone_atoms();
 
     smt::UnsafeTerm ws_expr(smt::literal<smt::Bool>(true));
+
+    // distinct nodes of a happens-before matrix are always ordered
+    if (encoders.options().happens_before == HappensBefore::MATRIX) {
+      return ws_expr;
+    }
+
     for (const Zone& zone : zone_atoms) {
       const EventPtrSet write_event_ptrs = relation.find(zone,
         WriteEventPredicate::predicate());
@@ -440,8 +600,7 @@ public:
       }
 
       if (1 < ptrs.size()) {
-        const smt::UnsafeTerm zone_ws_expr(smt::distinct(std::move(ptrs)));
-        ws_expr = ws_expr and zone_ws_expr;
+        conjoin_distinct(ws_expr, std::move(ptrs), encoders);
       }
     }
 
@@ -453,6 +612,25 @@ public:
     const ZoneAtomSet& zone_atoms = relation.zone_atoms();
 
     smt::UnsafeTerm rs_expr(smt::literal<smt::Bool>(true));
+    if (encoders.options().read_from == ReadFrom::SELECTORS) {
+      // every write event is read at most once
+      for (const Zone& zone : zone_atoms) {
+        const std::pair<EventPtrSet, EventPtrSet> result =
+          relation.partition(zone);
+        if (result.first.size() < 2) { continue; }
+
+        for (const EventPtr& write_event_ptr : result.second) {
+          smt::UnsafeTerms selectors;
+          selectors.reserve(result.first.size());
+          for (const EventPtr& read_event_ptr : result.first) {
+            selectors.push_back(encoders.rf(*write_event_ptr, *read_event_ptr));
+          }
+          conjoin(rs_expr, at_most_one(selectors), encoders);
+        }
+      }
+      return rs_expr;
+    }
+
     for (const Zone& zone : zone_atoms) {
       const EventPtrSet read_event_ptrs = relation.find(zone,
         ReadEventPredicate::predicate());
@@ -466,19 +644,50 @@ public:
       }
 
       if (1 < ptrs.size()) {
-        const smt::UnsafeTerm zone_rs_expr(smt::distinct(std::move(ptrs)));
-        rs_expr = rs_expr and zone_rs_expr;
+        conjoin_distinct(rs_expr, std::move(ptrs), encoders);
       }
     }
 
     return rs_expr;
   }
 
+  /// Estimated number of axiom instances generated by encode_without_ws()
+
+  /// For each zone atom with `r` read and `w` write events, we count `r*w`
+  /// read-from pairs and `r*r*w*(w-1)` stack instances, plus `(w-1)*(w-2)`
+  /// instances for each of the `m` read-modify-write events among the write
+  /// events. The distinctness constraints added by encode() are not counted.
+  static unsigned long long estimate(const ZoneRelation<Event>& relation) {
+    unsigned long long size = 0;
+    for (const Zone& zone : relation.zone_atoms()) {
+      const std::pair<EventPtrSet, EventPtrSet> result =
+        relation.partition(zone);
+      const unsigned long long r = result.first.size();
+      const unsigned long long w = result.second.size();
+
+      size += r * w;
+      if (w < 2) { continue; }
+
+      unsigned long long m = 0;
+      for (const EventPtr& write_event_ptr : result.second) {
+        if (write_event_ptr->rmw_read_event_ptr()) { m++; }
+      }
+
+      size += r * r * w * (w - 1) + m * (w - 1) * (w - 2);
+    }
+    return size;
+  }
+
   void encode_without_ws(const ZoneRelation<Event>& zone_relation, Encoders& encoders) const
   {
     encoders.solver.unsafe_add(rf_enc(zone_relation, encoders));
+    encoders.solver.unsafe_add(rmw_enc(zone_relation, encoders));
     //encoders.solver.unsafe_add(fr_enc(zone_relation, encoders));
-    encoders.solver.unsafe_add(stack_enc(zone_relation, encoders));
+    if (encoders.options().refine_axioms) {
+      defer_stack_enc(zone_relation, encoders);
+    } else {
+      encoders.solver.unsafe_add(stack_enc(zone_relation, encoders));
+    }
   }
 
   void encode(const ZoneRelation<Event>& zone_relation, Encoders& encoders) const
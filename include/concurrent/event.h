@@ -8,6 +8,7 @@
 #include <cassert>
 #include <cstddef>
 #include <memory>
+#include <forward_list>
 
 #include "core/type.h"
 
@@ -25,6 +26,8 @@ class ReadInstr;
 
 class Encoders;
 class ValueEncoder;
+class RangeAnalysis;
+class EventCloner;
 
 // On 32-bit architectures, the maximal write event identifier is 2^30-1.
 // This upper limit stems from Z3 which aligns char pointers for symbol
@@ -49,7 +52,8 @@ typedef unsigned ThreadId;
 /// is said to be conditional; otherwise, it is said to be unconditional.
 class Event {
 private:
-  static unsigned s_next_id;
+  // \internal counter of the current Session
+  static unsigned& next_id();
 
   const EventId m_event_id;
   const ThreadId m_thread_id;
@@ -72,7 +76,7 @@ protected:
   Event(ThreadId thread_id, const Zone& zone, bool is_read,
     const Type* const type_ptr,
     const std::shared_ptr<ReadInstr<bool>>& condition_ptr = nullptr) :
-    m_event_id(s_next_id++), m_zone(zone), m_thread_id(thread_id),
+    m_event_id(next_id()++), m_zone(zone), m_thread_id(thread_id),
     m_is_read(is_read), m_type_ptr(type_ptr), m_condition_ptr(condition_ptr) {
 
     assert(type_ptr != nullptr);
@@ -99,7 +103,10 @@ protected:
   }
 
 public:
-  static void reset_id(unsigned id = 0) { s_next_id = id; }
+  static void reset_id(unsigned id = 0) { next_id() = id; }
+
+  /// Identifier of the next event that is created
+  static EventId peek_id() { return next_id(); }
 
   virtual ~Event() {}
 
@@ -108,6 +115,19 @@ public:
   const Zone& zone() const { return m_zone; }
   bool is_read() const { return m_is_read; }
   bool is_write() const { return !m_is_read; }
+
+  /// Does the event synchronize threads rather than access memory?
+  virtual bool is_sync() const { return false; }
+
+  /// Does the event begin or end an atomic region or a critical section,
+  /// see RegionEvent?
+  virtual bool is_region() const { return false; }
+
+  /// Read event of a read-modify-write operation, see ReadModifyWriteEvent
+
+  /// \returns nullptr unless the event is the write of such an operation
+  virtual const Event* rmw_read_event_ptr() const { return nullptr; }
+
   const Type& type() const { return *m_type_ptr; }
 
   /// Condition that guards the event
@@ -121,8 +141,21 @@ public:
     return m_event_id == other.m_event_id;
   }
 
+  /// Append all read events that determine the value of this event
+  virtual void filter(std::forward_list<std::shared_ptr<Event>>&) const { /* skip */ }
+
   virtual smt::UnsafeTerm encode_eq(const ValueEncoder& encoder, Encoders& helper) const = 0;
   virtual smt::UnsafeTerm constant(Encoders& helper) const = 0;
+
+  /// Add the nodes of the event's value to the given analysis, if any
+  virtual void range(RangeAnalysis& analysis) const { /* skip */ }
+
+  /// Fresh copy of the event, see EventCloner
+
+  /// \returns nullptr if the event cannot be cloned
+  virtual std::shared_ptr<Event> clone(EventCloner& cloner) const {
+    return nullptr;
+  }
 };
 
 #define DECL_VALUE_ENCODER_C0_FN \
@@ -131,6 +164,12 @@ public:
 #define DECL_CONSTANT_ENCODER_C0_FN \
   smt::UnsafeTerm constant(Encoders& helper) const;
 
+#define DECL_RANGE_FN \
+  void range(RangeAnalysis& analysis) const;
+
+#define DECL_CLONE_FN \
+  std::shared_ptr<Event> clone(EventCloner& cloner) const;
+
 /// Event that writes to memory through a variable of type `T`
 template<typename T>
 class WriteEvent : public Event {
@@ -152,6 +191,10 @@ public:
   virtual ~WriteEvent() {}
 
   const ReadInstr<T>& instr_ref() const { return *m_instr_ptr; }
+
+  void filter(std::forward_list<std::shared_ptr<Event>>& event_ptrs) const {
+    m_instr_ptr->filter(event_ptrs);
+  }
 };
 
 /// Direct memory write event
@@ -170,6 +213,8 @@ public:
 
   DECL_VALUE_ENCODER_C0_FN
   DECL_CONSTANT_ENCODER_C0_FN
+  DECL_RANGE_FN
+  DECL_CLONE_FN
 };
 
 template<typename T, typename U> class DerefReadInstr;
@@ -198,8 +243,15 @@ public:
     return *m_deref_instr_ptr;
   }
 
+  void filter(std::forward_list<std::shared_ptr<Event>>& event_ptrs) const {
+    WriteEvent<T>::filter(event_ptrs);
+    m_deref_instr_ptr->filter(event_ptrs);
+  }
+
   DECL_VALUE_ENCODER_C0_FN
   DECL_CONSTANT_ENCODER_C0_FN
+  DECL_RANGE_FN
+  DECL_CLONE_FN
 };
 
 /// Event that reads `sizeof(T)` bytes from memory
@@ -210,6 +262,8 @@ private:
   friend std::unique_ptr<ReadEvent<U>> internal_make_read_event(
     const Zone& zone, EventId event_id);
 
+  friend class EventCloner;
+
   ReadEvent(EventId event_id, ThreadId thread_id, const Zone& zone,
     const std::shared_ptr<ReadInstr<bool>>& condition_ptr = nullptr) :
     Event(event_id, thread_id, zone, true, &TypeInfo<T>::s_type, condition_ptr) {}
@@ -223,6 +277,43 @@ public:
 
   DECL_VALUE_ENCODER_C0_FN
   DECL_CONSTANT_ENCODER_C0_FN
+  DECL_CLONE_FN
+};
+
+/// Direct write event of an atomic read-modify-write operation
+
+/// The write event follows its read event in program order, and no other
+/// write event to the same memory happens between the write event that is
+/// read and this one. Its value is typically a function of the value read.
+/// A conditional operation can have several write events, but at most one
+/// of them must satisfy its condition, see SharedVar::compare_exchange().
+template<typename T>
+class ReadModifyWriteEvent : public DirectWriteEvent<T> {
+private:
+  // Never null
+  const std::shared_ptr<ReadEvent<T>> m_read_event_ptr;
+
+public:
+  ReadModifyWriteEvent(ThreadId thread_id, const Zone& zone,
+    const std::shared_ptr<ReadEvent<T>>& read_event_ptr,
+    std::unique_ptr<ReadInstr<T>> instr_ptr,
+    const std::shared_ptr<ReadInstr<bool>>& condition_ptr = nullptr) :
+    DirectWriteEvent<T>(thread_id, zone, std::move(instr_ptr), condition_ptr),
+    m_read_event_ptr(read_event_ptr) {
+
+    assert(nullptr != m_read_event_ptr);
+    assert(zone == m_read_event_ptr->zone());
+  }
+
+  ~ReadModifyWriteEvent() {}
+
+  const std::shared_ptr<ReadEvent<T>>& read_event_ptr() const {
+    return m_read_event_ptr;
+  }
+
+  const Event* rmw_read_event_ptr() const { return m_read_event_ptr.get(); }
+
+  DECL_CLONE_FN
 };
 
 /// \internal Event for thread synchronization
@@ -237,6 +328,9 @@ protected:
   SyncEvent(ThreadId thread_id, const Zone& zone, bool receive,
     const std::shared_ptr<ReadInstr<bool>>& condition_ptr = nullptr) :
     Event(thread_id, zone, receive, &TypeInfo<Sync>::s_type, condition_ptr) {}
+
+public:
+  bool is_sync() const { return true; }
 };
 
 /// \internal Write event for thread synchronization
@@ -258,6 +352,58 @@ public:
     SyncEvent(thread_id, zone, true, condition_ptr) {}
 };
 
+class Mutex;
+
+/// \internal Event that begins or ends an atomic region of a thread
+
+/// Region events do not access memory, i.e. their zone is bottom, but they
+/// are ordered with the events of their thread like any other event. Every
+/// event of another thread that accesses the memory in a region happens
+/// either before its begin or after its end event, see se::atomic_begin().
+class RegionEvent : public SyncEvent {
+private:
+  const bool m_is_begin;
+
+  // nullptr unless the region is a critical section, see LockEvent
+  const Mutex* const m_mutex_ptr;
+
+protected:
+  RegionEvent(ThreadId thread_id, const Mutex* mutex_ptr, bool is_begin,
+    const std::shared_ptr<ReadInstr<bool>>& condition_ptr) :
+    SyncEvent(thread_id, Zone::bottom(), true, condition_ptr),
+    m_is_begin(is_begin),
+    m_mutex_ptr(mutex_ptr) {}
+
+public:
+  RegionEvent(ThreadId thread_id, bool is_begin,
+    const std::shared_ptr<ReadInstr<bool>>& condition_ptr = nullptr) :
+    RegionEvent(thread_id, nullptr, is_begin, condition_ptr) {}
+
+  bool is_region() const { return true; }
+
+  /// Does the event begin rather than end the region?
+  bool is_begin() const { return m_is_begin; }
+
+  /// Mutex of a critical section, or nullptr if the region is atomic
+  const Mutex* mutex_ptr() const { return m_mutex_ptr; }
+};
+
+/// \internal Event that locks or unlocks a Mutex
+
+/// The events of a thread between a lock event and the next unlock event of
+/// the same mutex form a critical section. Critical sections of the same
+/// mutex in different threads never overlap, but unlike atomic regions they
+/// do not order events outside of any critical section of that mutex.
+class LockEvent : public RegionEvent {
+public:
+  LockEvent(ThreadId thread_id, const Mutex& mutex, bool is_lock,
+    const std::shared_ptr<ReadInstr<bool>>& condition_ptr = nullptr) :
+    RegionEvent(thread_id, &mutex, is_lock, condition_ptr) {}
+
+  /// Does the event begin rather than end the critical section?
+  bool is_lock() const { return is_begin(); }
+};
+
 }
 
 #endif
@@ -20,6 +20,8 @@ namespace se {
 
 class Encoders;
 class ReadInstrEncoder;
+class RangeAnalysis;
+class EventCloner;
 
 /// Non-copyable class that identifies a built-in memory read instruction
 
@@ -45,12 +47,21 @@ public:
   virtual void filter(std::forward_list<std::shared_ptr<Event>>&) const = 0;
   virtual smt::UnsafeTerm encode(const ReadInstrEncoder& encoder, Encoders& helper) const = 0;
 
+  /// Node of the instruction's value, see RangeAnalysis
+  virtual size_t range(RangeAnalysis& analysis) const = 0;
+
   virtual std::shared_ptr<ReadInstr<bool>> condition_ptr() const = 0;
+
+  /// Copy of the instruction that reads from fresh events, see EventCloner
+  virtual std::unique_ptr<ReadInstr<T>> clone(EventCloner& cloner) const = 0;
 };
 
 #define READ_ENCODER_FN_DECL \
   smt::UnsafeTerm encode(const ReadInstrEncoder& encoder, Encoders& helper) const;
 
+#define RANGE_FN_DECL \
+  size_t range(RangeAnalysis& analysis) const;
+
 template<typename T>
 class LiteralReadInstr : public ReadInstr<T> {
 private:
@@ -80,6 +91,9 @@ public:
   void filter(std::forward_list<std::shared_ptr<Event>>&) const { /* skip */ }
 
   READ_ENCODER_FN_DECL
+  RANGE_FN_DECL
+
+  std::unique_ptr<ReadInstr<T>> clone(EventCloner& cloner) const;
 };
 
 /// Array filled with identical literals
@@ -108,6 +122,9 @@ public:
   void filter(std::forward_list<std::shared_ptr<Event>>&) const { /* skip */ }
 
   READ_ENCODER_FN_DECL
+  RANGE_FN_DECL
+
+  std::unique_ptr<ReadInstr<T[N]>> clone(EventCloner& cloner) const;
 };
 
 template<typename T>
@@ -140,6 +157,9 @@ public:
   }
 
   READ_ENCODER_FN_DECL
+  RANGE_FN_DECL
+
+  std::unique_ptr<ReadInstr<T>> clone(EventCloner& cloner) const;
 };
 
 template<Opcode opcode, typename U>
@@ -148,6 +168,7 @@ private:
   const std::shared_ptr<ReadInstr<U>> m_operand_ptr;
 
   friend class Bools;
+  friend class EventCloner;
   UnaryReadInstr(std::shared_ptr<ReadInstr<U>> operand_ptr) :
     m_operand_ptr(operand_ptr) {}
 
@@ -171,6 +192,10 @@ public:
   }
 
   READ_ENCODER_FN_DECL
+  RANGE_FN_DECL
+
+  std::unique_ptr<ReadInstr<typename ReturnType<opcode, U>::result_type>>
+  clone(EventCloner& cloner) const;
 };
 
 template<Opcode opcode, typename U, typename V>
@@ -208,6 +233,10 @@ public:
   }
 
   READ_ENCODER_FN_DECL
+  RANGE_FN_DECL
+
+  std::unique_ptr<ReadInstr<typename ReturnType<opcode, U, V>::result_type>>
+  clone(EventCloner& cloner) const;
 };
 
 /// Commutative monoid read instruction
@@ -265,6 +294,9 @@ public:
   }
 
   READ_ENCODER_FN_DECL
+  RANGE_FN_DECL
+
+  std::unique_ptr<ReadInstr<T>> clone(EventCloner& cloner) const;
 };
 
 /// Load memory of type `T` at an offset of type `U`
@@ -296,6 +328,9 @@ public:
   }
 
   READ_ENCODER_FN_DECL
+  RANGE_FN_DECL
+
+  std::unique_ptr<ReadInstr<T>> clone(EventCloner& cloner) const;
 };
 
 template<typename ...T> struct ReadInstrResult;
@@ -11,30 +11,40 @@ using namespace se::ops;
 
 namespace se {
 
-/// Symbolic spinlock
-
-/// The Mutex class symbolically encodes a spinlock that protects shared data
-/// from being simultaneously accessed by multiple threads.
+/// Symbolic mutex
+
+/// The Mutex class protects shared data from being simultaneously accessed
+/// by multiple threads. Its lock() and unlock() calls are recorded as
+/// LockEvent objects that are ordered with the other events of their thread,
+/// and Threads::encode() ensures that the critical sections of the same
+/// mutex in different threads do not overlap. The mutex itself is not
+/// shared memory, so it adds no reads or writes to the encoding.
 class Mutex {
 private:
   unsigned m_lock_thread_id;
-  SharedVar<unsigned> m_thread_id;
+
+  void append(bool is_lock) const {
+    const std::shared_ptr<Event> event_ptr(new LockEvent(
+      ThisThread::thread_id(), *this, is_lock,
+      ThisThread::path_condition_ptr()));
+    Threads::slice_append(ThisThread::thread_id(), event_ptr);
+  }
 
 protected:
-  void unlock(Encoders& encoders) {
+  void unlock(Encoders&) {
     assert(m_lock_thread_id == ThisThread::thread_id());
-    Threads::expect(m_thread_id == m_lock_thread_id, encoders);
+    append(false);
   }
 
 public:
-  Mutex() : m_lock_thread_id(0), m_thread_id() {}
+  Mutex() : m_lock_thread_id(0) {}
 
-  /// Acquire lock
+  Mutex(const Mutex&) = delete;
 
-  // TODO: Ensure recorder preserves PO between lock() and unlock()
+  /// Acquire lock
   void lock() {
     m_lock_thread_id = ThisThread::thread_id();
-    m_thread_id = m_lock_thread_id;
+    append(true);
   }
 
   /// Release lock
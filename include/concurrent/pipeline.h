@@ -0,0 +1,80 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_PIPELINE_H_
+#define LIBSE_CONCURRENT_PIPELINE_H_
+
+#include <functional>
+
+#include "concurrent/session.h"
+#include "concurrent/slicer.h"
+
+namespace se {
+
+/// Overlaps the recording of slices with the solving of earlier ones
+
+/// Every slice of a Slicer is recorded and encoded in its own Session. While
+/// the solver checks a slice on another thread, the next slices are already
+/// being recorded and encoded on the calling thread. The results are
+/// processed in the order of the slices. After the first satisfiable slice,
+/// no further slices are recorded.
+///
+/// Since every slice has its own session, each recording must start from
+/// scratch, i.e. also record the initialization of shared variables.
+///
+/// Example:
+///
+///      se::Slicer slicer(se::MAX_SLICE_FREQ);
+///      se::SlicePipeline pipeline(slicer);
+///      if (smt::sat == pipeline.run([](se::Encoders& encoders) {
+///            se::Threads::reset();
+///            se::Threads::begin_main_thread();
+///            ...
+///            return se::Threads::end_main_thread(encoders);
+///          })) { ... }
+class SlicePipeline {
+public:
+  /// Records and encodes the current slice with the given encoders
+
+  /// The current session is the slice's session.
+  ///
+  /// \returns is there at least one error condition to check?
+  typedef std::function<bool(Encoders&)> RecordFn;
+
+private:
+  Slicer& m_slicer;
+  const unsigned m_lookahead;
+  unsigned long long m_slice_count;
+  unsigned long long m_sat_slice;
+
+public:
+  /// \param lookahead number of slices that may be recorded and encoded
+  ///                  ahead of the oldest slice that is still being checked
+  ///
+  /// \pre 0 < lookahead
+  SlicePipeline(Slicer& slicer, unsigned lookahead = 1);
+  SlicePipeline(const SlicePipeline&) = delete;
+
+  /// Number of recorded slices
+  unsigned long long slice_count() const {
+    return m_slice_count;
+  }
+
+  /// Number of the first satisfiable slice, counting from one
+
+  /// \returns zero if no satisfiable slice has been found
+  unsigned long long sat_slice() const {
+    return m_sat_slice;
+  }
+
+  /// Record and check every slice until one of them is satisfiable
+
+  /// \returns smt::sat if and only if some slice is satisfiable, smt::unsat
+  ///          if all slices are unsatisfiable, and smt::unknown otherwise
+  smt::CheckResult run(const RecordFn& record_fn);
+};
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_PORTFOLIO_H_
+#define LIBSE_CONCURRENT_PORTFOLIO_H_
+
+#include <string>
+#include <vector>
+
+#include "concurrent/encoder.h"
+
+namespace se {
+
+/// Named encoding of a recording
+struct PortfolioConfig {
+  std::string name;
+  EncoderOptions options;
+};
+
+/// Races several encodings of the same recording against each other
+
+/// Every configuration encodes and checks the recorded threads in its own
+/// forked child process. The first child that determines whether the
+/// recording is satisfiable wins; all other children are killed. The
+/// Portfolio keeps track of how often each configuration has won.
+///
+/// Example:
+///
+///      se::Portfolio portfolio(configs);
+///      slicer.begin_slice_loop();
+///      do {
+///        se::Thread::encoders().reset();
+///        ...
+///        if (smt::sat == portfolio.check()) { ... }
+///      } while (slicer.next_slice());
+class Portfolio {
+private:
+  const std::vector<PortfolioConfig> m_configs;
+  std::vector<unsigned long long> m_win_counts;
+  size_t m_winner;
+
+public:
+  /// No configuration has won the last check()
+  static constexpr size_t NO_WINNER = static_cast<size_t>(-1);
+
+  /// \pre configs is not empty
+  Portfolio(const std::vector<PortfolioConfig>& configs);
+  Portfolio(const Portfolio&) = delete;
+
+  size_t size() const {
+    return m_configs.size();
+  }
+
+  const PortfolioConfig& config(size_t index) const {
+    return m_configs.at(index);
+  }
+
+  /// How often has the given configuration won so far?
+  unsigned long long win_count(size_t index) const {
+    return m_win_counts.at(index);
+  }
+
+  /// Index of the configuration that has won the last check()
+
+  /// \returns NO_WINNER if no configuration has determined the result
+  size_t winner() const {
+    return m_winner;
+  }
+
+  /// Encode and check the recorded threads with every configuration
+
+  /// Instead of calling Threads::encode(Encoders&), the recording is
+  /// encoded by the child processes. Afterwards, the recording is discarded
+  /// in the calling process.
+  ///
+  /// \returns smt::sat or smt::unsat as determined by the winner, and
+  ///          smt::unknown if no configuration has determined the result
+  smt::CheckResult check();
+};
+
+}
+
+#endif
@@ -0,0 +1,467 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_RANGE_H_
+#define LIBSE_CONCURRENT_RANGE_H_
+
+#include <limits>
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+
+#include "concurrent/event.h"
+#include "concurrent/instr.h"
+
+namespace se {
+
+/// Closed interval of integers, possibly empty or unbounded
+class Range {
+private:
+  bool m_is_top;
+  long long m_lo;
+  long long m_hi;
+
+  Range(bool is_top, long long lo, long long hi)
+  : m_is_top(is_top), m_lo(lo), m_hi(hi) {}
+
+public:
+  /// Empty interval
+  Range() : m_is_top(false), m_lo(1), m_hi(0) {}
+
+  /// Interval that contains exactly the given value
+  static Range value(long long value) {
+    return Range(false, value, value);
+  }
+
+  /// Interval of all the integers from lo up to and including hi
+  static Range interval(long long lo, long long hi) {
+    return Range(false, lo, hi);
+  }
+
+  /// Interval about which nothing is known
+  static Range top() {
+    return Range(true, 0, 0);
+  }
+
+  bool is_top() const { return m_is_top; }
+  bool is_empty() const { return !m_is_top && m_hi < m_lo; }
+
+  /// \pre !is_top() && !is_empty()
+  long long lo() const { return m_lo; }
+
+  /// \pre !is_top() && !is_empty()
+  long long hi() const { return m_hi; }
+
+  /// Smallest interval that contains both intervals
+  Range join(const Range& other) const;
+
+  /// Interval of all sums, or top if they may overflow
+  Range add(const Range& other) const;
+
+  /// Interval of all differences, or top if they may overflow
+  Range sub(const Range& other) const;
+
+  /// Interval of all negated values, or top if they may overflow
+  Range neg() const;
+
+  /// Fewest number of bits of a two's complement or unsigned bit vector
+  /// that can represent every value in the interval
+
+  /// An unsigned bit vector cannot represent negative values without
+  /// wrapping around, so such intervals need all 64 bits.
+  ///
+  /// \pre !is_top()
+  unsigned bit_width(bool is_signed) const;
+
+  bool operator==(const Range& other) const {
+    if (m_is_top || other.m_is_top) {
+      return m_is_top == other.m_is_top;
+    }
+    if (is_empty() || other.is_empty()) {
+      return is_empty() == other.is_empty();
+    }
+    return m_lo == other.m_lo && m_hi == other.m_hi;
+  }
+
+  bool operator!=(const Range& other) const {
+    return !(*this == other);
+  }
+};
+
+/// Infers the bit widths that suffice for the values of a recording
+
+/// Every recorded event and literal is a node whose interval must contain
+/// all the values it can take in any execution of the recording. Values
+/// flow from write events to the read events whose zones overlap (or, for
+/// thread-local memory, to read events with the same event identifier),
+/// and through arithmetic read instructions. The intervals are computed as
+/// a fixpoint; every interval that still grows after a few rounds is
+/// widened to Range::top().
+///
+/// Since the operands of an operator must have the same sort, nodes are
+/// partitioned into classes by a union-find data structure: the operands
+/// and result of arithmetic operators, the operands of comparisons, a write
+/// event and its value, and all the events that can read from each other
+/// are in the same class. Every node of a class is encoded with the same
+/// bit width, namely the fewest bits that represent the union of all the
+/// intervals in the class. If any interval in a class is unbounded, or if
+/// the signedness of its nodes differ, then the class is not narrowed.
+///
+/// Array elements and array indexes are separate nodes. Since array sorts
+/// can only be created from C++ types, classes that involve arrays are
+/// only narrowed to 8, 16 or 32 bits.
+class RangeAnalysis {
+public:
+  typedef size_t Node;
+  typedef std::unordered_map<const void*, unsigned> Widths;
+
+  /// Result of read instructions whose values are Boolean
+  static constexpr Node NONE = static_cast<Node>(-1);
+
+private:
+  // The greater the number of rounds, the more intervals converge without
+  // being widened, but every round takes time linear in the recording.
+  static constexpr unsigned s_widen_round = 8;
+
+  struct NodeInfo {
+    Node parent;
+    Range range;
+    bool is_signed;
+    unsigned bv_size;
+
+    // array element node with a separate node for its index, or NONE
+    Node index;
+
+    // element or index of an array?
+    bool is_array;
+  };
+
+  enum class Transfer { COPY, ADD, SUB, NEG };
+
+  // target ⊇ f(lhs, rhs) where rhs is only used by binary functions
+  struct Flow {
+    Transfer transfer;
+    Node target;
+    Node lhs;
+    Node rhs;
+  };
+
+  std::vector<NodeInfo> m_nodes;
+  std::vector<Flow> m_flows;
+
+  // keys are events and read instructions
+  std::unordered_map<const void*, Node> m_node_map;
+
+  std::vector<std::pair<const Event*, Node>> m_reads;
+  std::vector<std::pair<const Event*, Node>> m_writes;
+
+  Widths m_value_widths;
+  Widths m_index_widths;
+
+  Node find(Node node);
+  void unite(Node x, Node y);
+  void flow(Transfer transfer, Node target, Node lhs, Node rhs = NONE);
+
+  Node make_node(bool is_signed, unsigned bv_size);
+
+  // finds or creates the node of the given event or read instruction
+  Node key_node(const void* key, bool is_signed, unsigned bv_size);
+
+  // finds or creates an array element node and its index node
+  Node key_array_node(const void* key, bool is_signed, unsigned bv_size);
+
+  bool has_node(const void* key) const {
+    return m_node_map.count(key) != 0;
+  }
+
+  void join_range(Node node, const Range& range);
+
+  // Every value of the source can be a value of the target, and both must
+  // have the same width; the same holds for their indexes, if any
+  void reads_from(Node target, Node source);
+
+  void fixpoint();
+  void export_widths();
+
+  template<typename T>
+  static bool is_bool() {
+    return std::is_same<T, bool>::value;
+  }
+
+  template<typename T>
+  static Range literal_range(const T& value) {
+    if (std::is_unsigned<T>::value && static_cast<unsigned long long>(value) >
+        static_cast<unsigned long long>(std::numeric_limits<long long>::max())) {
+      return Range::top();
+    }
+    return Range::value(static_cast<long long>(value));
+  }
+
+  template<typename T>
+  Node value_node(const void* key) {
+    return key_node(key, std::is_signed<T>::value, 8 * sizeof(T));
+  }
+
+  template<typename T>
+  Node array_node(const void* key) {
+    return key_array_node(key, std::is_signed<T>::value, 8 * sizeof(T));
+  }
+
+  void add_condition(const std::shared_ptr<ReadInstr<bool>>& condition_ptr) {
+    if (condition_ptr) {
+      condition_ptr->range(*this);
+    }
+  }
+
+public:
+  RangeAnalysis();
+  RangeAnalysis(const RangeAnalysis&) = delete;
+
+  /// Add the event, its value and its condition
+  void add(const Event& event);
+
+  /// Add every read instruction in the given condition
+  void add(const ReadInstr<bool>& condition) {
+    condition.range(*this);
+  }
+
+  /// Compute the intervals and bit widths of all the added events
+
+  /// \pre every event that can be read from has been added
+  void solve();
+
+  /// Interval of the given event or literal read instruction
+
+  /// \pre solve() has been called
+  Range range(const void* key) const;
+
+  /// Bit widths of the values of events and literals that are narrower than
+  /// their C++ types, keyed by the address of the event or literal read
+  /// instruction; array events and literals map to their element width
+  const Widths& value_widths() const {
+    return m_value_widths;
+  }
+
+  /// Bit widths of the indexes of array events and literals that are
+  /// narrower than `size_t`
+  const Widths& index_widths() const {
+    return m_index_widths;
+  }
+
+  // Visitors of read instructions and events, see RANGE_FN_DEF
+
+  template<typename T>
+  Node visit(const LiteralReadInstr<T>& instr) {
+    if (is_bool<T>()) {
+      return NONE;
+    }
+
+    const Node node = value_node<T>(&instr);
+    join_range(node, literal_range(instr.literal()));
+    return node;
+  }
+
+  template<typename T, size_t N>
+  Node visit(const LiteralReadInstr<T[N]>& instr) {
+    if (is_bool<T>()) {
+      return NONE;
+    }
+
+    const Node node = array_node<T>(&instr);
+    join_range(node, literal_range(instr.element_literal()));
+    join_range(m_nodes[node].index, Range::interval(0, N - 1));
+    return node;
+  }
+
+  template<typename T>
+  Node visit(const BasicReadInstr<T>& instr) {
+    if (is_bool<T>()) {
+      return NONE;
+    }
+
+    const Event* const event_ptr = instr.event_ptr().get();
+    const bool is_new = !has_node(event_ptr);
+    const Node node = value_node<T>(event_ptr);
+    if (is_new) {
+      m_reads.emplace_back(event_ptr, node);
+    }
+    return node;
+  }
+
+  template<typename T, size_t N>
+  Node visit(const BasicReadInstr<T[N]>& instr) {
+    if (is_bool<T>()) {
+      return NONE;
+    }
+
+    const Event* const event_ptr = instr.event_ptr().get();
+    const bool is_new = !has_node(event_ptr);
+    const Node node = array_node<T>(event_ptr);
+    if (is_new) {
+      m_reads.emplace_back(event_ptr, node);
+    }
+    return node;
+  }
+
+  template<Opcode opcode, typename U>
+  Node visit(const UnaryReadInstr<opcode, U>& instr) {
+    typedef typename ReturnType<opcode, U>::result_type Result;
+
+    // conditions share their operands with each other
+    if (has_node(&instr)) {
+      return m_node_map.at(&instr);
+    }
+
+    const Node operand = instr.operand_ref().range(*this);
+    if (is_bool<Result>() || operand == NONE) {
+      return NONE;
+    }
+
+    const Node node = value_node<Result>(&instr);
+    unite(node, operand);
+    flow(opcode == SUB ? Transfer::NEG : Transfer::COPY, node, operand);
+    return node;
+  }
+
+  template<Opcode opcode, typename U, typename V>
+  Node visit(const BinaryReadInstr<opcode, U, V>& instr) {
+    typedef typename ReturnType<opcode, U, V>::result_type Result;
+
+    if (has_node(&instr)) {
+      return m_node_map.at(&instr);
+    }
+
+    const Node loperand = instr.loperand_ref().range(*this);
+    const Node roperand = instr.roperand_ref().range(*this);
+    if (loperand == NONE || roperand == NONE) {
+      return NONE;
+    }
+
+    unite(loperand, roperand);
+    if (is_bool<Result>()) {
+      return NONE;
+    }
+
+    const Node node = value_node<Result>(&instr);
+    unite(node, loperand);
+    if (opcode == ADD || opcode == SUB) {
+      flow(opcode == ADD ? Transfer::ADD : Transfer::SUB, node, loperand,
+        roperand);
+    } else {
+      join_range(node, Range::top());
+    }
+    return node;
+  }
+
+  template<Opcode opcode, typename T>
+  Node visit(const NaryReadInstr<opcode, T>& instr) {
+    Node node = NONE;
+    for (const std::shared_ptr<ReadInstr<T>>& operand_ptr : instr.operand_ptrs()) {
+      const Node operand = operand_ptr->range(*this);
+      if (operand == NONE) {
+        continue;
+      }
+
+      if (node == NONE) {
+        node = value_node<T>(&instr);
+        join_range(node, Range::top());
+      }
+      unite(node, operand);
+    }
+    return node;
+  }
+
+  template<typename T, typename U, size_t N>
+  Node visit(const DerefReadInstr<T[N], U>& instr) {
+    const Node memory = instr.memory_ref().range(*this);
+    const Node offset = instr.offset_ref().range(*this);
+    if (memory != NONE && offset != NONE) {
+      unite(m_nodes[memory].index, offset);
+    }
+    return memory;
+  }
+
+  template<typename T>
+  void visit(const DirectWriteEvent<T>& event) {
+    const Node value = event.instr_ref().range(*this);
+    if (is_bool<T>() || value == NONE) {
+      return;
+    }
+
+    const Node node = value_node<T>(&event);
+    unite(node, value);
+    flow(Transfer::COPY, node, value);
+    m_writes.emplace_back(&event, node);
+  }
+
+  template<typename T, size_t N>
+  void visit(const DirectWriteEvent<T[N]>& event) {
+    const Node value = event.instr_ref().range(*this);
+    if (is_bool<T>() || value == NONE) {
+      return;
+    }
+
+    // every element is initialized, see ValueEncoder
+    const Node node = array_node<T>(&event);
+    reads_from(node, value);
+    join_range(m_nodes[node].index, Range::interval(0, N - 1));
+    m_writes.emplace_back(&event, node);
+  }
+
+  template<typename T, typename U, size_t N>
+  void visit(const IndirectWriteEvent<T, U, N>& event) {
+    const Node value = event.instr_ref().range(*this);
+    const DerefReadInstr<T[N], U>& deref_instr = event.deref_instr_ref();
+    const Node memory = deref_instr.memory_ref().range(*this);
+    const Node offset = deref_instr.offset_ref().range(*this);
+    if (is_bool<T>() || value == NONE || memory == NONE || offset == NONE) {
+      return;
+    }
+
+    // the event stores the value in a copy of the memory
+    const Node node = array_node<T>(&event);
+    reads_from(node, memory);
+    unite(node, value);
+    flow(Transfer::COPY, node, value);
+    unite(m_nodes[node].index, offset);
+    flow(Transfer::COPY, m_nodes[node].index, offset);
+    m_writes.emplace_back(&event, node);
+  }
+};
+
+#define RANGE_FN_DEF \
+  range(RangeAnalysis& analysis) const {\
+    return analysis.visit(*this);\
+  }
+
+template<typename T> size_t LiteralReadInstr<T>::RANGE_FN_DEF
+template<typename T, size_t N> size_t LiteralReadInstr<T[N]>::RANGE_FN_DEF
+template<typename T> size_t BasicReadInstr<T>::RANGE_FN_DEF
+
+template<Opcode opcode, typename T>
+size_t UnaryReadInstr<opcode, T>::RANGE_FN_DEF
+
+template<Opcode opcode, typename T, typename U>
+size_t BinaryReadInstr<opcode, T, U>::RANGE_FN_DEF
+
+template<Opcode opcode, typename T>
+size_t NaryReadInstr<opcode, T>::RANGE_FN_DEF
+
+template<typename T, typename U, size_t N>
+size_t DerefReadInstr<T[N], U>::RANGE_FN_DEF
+
+#define EVENT_RANGE_FN_DEF \
+  range(RangeAnalysis& analysis) const {\
+    analysis.visit(*this);\
+  }
+
+template<typename T>
+void DirectWriteEvent<T>::EVENT_RANGE_FN_DEF
+
+template<typename T, typename U, size_t N>
+void IndirectWriteEvent<T, U, N>::EVENT_RANGE_FN_DEF
+
+}
+
+#endif
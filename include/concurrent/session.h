@@ -0,0 +1,104 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_SESSION_H_
+#define LIBSE_CONCURRENT_SESSION_H_
+
+#include "concurrent/zone.h"
+#include "concurrent/event.h"
+#include "concurrent/encoder_c0.h"
+#include "concurrent/thread.h"
+
+namespace se {
+
+/// State of a single verification problem
+
+/// A session owns the identifier counters of events, zones and threads, the
+/// recorded threads and their error conditions, and the encoders. Every
+/// operating system thread has a current session which is used by the API
+/// such as SharedVar, Thread and Threads. Unless it has been changed with a
+/// Session::Scope, the current session is the process-wide default session.
+///
+/// Therefore, independent verification problems can be analyzed in parallel
+/// by giving every operating system thread its own session.
+///
+/// Example:
+///
+///      std::thread worker([]() {
+///        se::Session session;
+///        se::Session::Scope scope(session);
+///
+///        se::Threads::reset();
+///        se::Threads::begin_main_thread();
+///        ...
+///        se::Threads::end_main_thread(session.encoders());
+///        session.encoders().check();
+///      });
+class Session {
+private:
+  friend class Zone;
+  friend class Event;
+  friend class Thread;
+  friend class Threads;
+  friend Encoders& global_encoders();
+
+  // nullptr if and only if the default session is current
+  static thread_local Session* s_current_session_ptr;
+
+  static Session& default_session();
+
+  unsigned m_next_event_id;
+  unsigned m_next_atom;
+  ThreadId m_next_thread_id;
+
+  // must be deallocated after the error conditions of the threads
+  Encoders m_encoders;
+  Threads m_threads;
+
+public:
+  /// Makes the given session the current one of the calling thread
+  class Scope {
+  private:
+    Session* const m_previous_session_ptr;
+
+  public:
+    explicit Scope(Session& session) :
+      m_previous_session_ptr(s_current_session_ptr) {
+
+      s_current_session_ptr = &session;
+    }
+
+    Scope(const Scope&) = delete;
+
+    /// Restores the previously current session
+    ~Scope() {
+      s_current_session_ptr = m_previous_session_ptr;
+    }
+  };
+
+  Session() :
+    m_next_event_id(0),
+    m_next_atom(0),
+    m_next_thread_id(0),
+    m_encoders(),
+    m_threads() {}
+
+  Session(const Session&) = delete;
+
+  /// Session of the calling operating system thread
+  static Session& current() {
+    if (s_current_session_ptr == nullptr) {
+      return default_session();
+    }
+    return *s_current_session_ptr;
+  }
+
+  Encoders& encoders() {
+    return m_encoders;
+  }
+};
+
+}
+
+#endif
@@ -198,6 +198,15 @@ public:
   void begin_then(std::shared_ptr<ReadInstr<bool>> condition_ptr) {
     assert(nullptr != condition_ptr);
     append_all(*condition_ptr);
+    begin_then_block(std::move(condition_ptr));
+  }
+
+  /// Begin conditional block without appending the condition's read events
+
+  /// This is the same as begin_then() except that the caller is responsible
+  /// for appending the read events in the condition, see Threads::replay().
+  void begin_then_block(std::shared_ptr<ReadInstr<bool>> condition_ptr) {
+    assert(nullptr != condition_ptr);
 
     if (m_current_block_ptr->condition_ptr()) {
       // start nested branch inside current conditional block
@@ -6,9 +6,15 @@
 #define LIBSE_CONCURRENT_SLICER_H_
 
 #include <map>
+#include <set>
 #include <stack>
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <forward_list>
 
 #include "concurrent/thread.h"
+#include "concurrent/cone.h"
 
 namespace se {
 
@@ -18,6 +24,26 @@ typedef unsigned Location;
 /// Slice every path in the series-parallel DAG
 constexpr unsigned MAX_SLICE_FREQ = (1u << 10);
 
+/// Upper bound on the estimated formula size of a slice
+
+/// The formula size is estimated by Z3OrderEncoderC0::estimate().
+struct SliceBudget {
+  unsigned long long size;
+};
+
+/// Branch location whose branch is fixed in all slices
+
+/// A pinned branch location is never flipped by Slicer::next_slice(). If the
+/// pin is required, then a slice is only owned by a Slicer if the location
+/// is executed, see Slicer::owns_slice().
+struct BranchPin {
+  Location loc;
+  bool execute;
+  bool required;
+};
+
+typedef std::vector<BranchPin> BranchPins;
+
 /// Renders a concurrent program as a set of series-parallel DAGs
 
 
@@ -51,26 +77,187 @@ constexpr unsigned MAX_SLICE_FREQ = (1u << 10);
 /// post-dominator of every control point in the program's control-flow
 /// graph to be computable. In general, this is impossible when there
 /// are goto statements that can jump to arbitrary program locations.
+///
+/// If only relevant branches are sliced, then a branch location is merged
+/// as soon as both its "then" and "else" blocks have been recorded, and
+/// neither of them writes to memory in the \ref DependencyCone "dependency
+/// cone" of the error and expect conditions. Subsequent slices execute both
+/// branches of merged locations, and next_slice() never flips them again.
+///
+/// Given a SliceBudget, a Slicer initially merges every branch location and
+/// only slices as many of them as are needed to keep the estimated formula
+/// size of each slice within the budget:
+///
+///      Slicer slicer(SliceBudget{1u << 20});
+///      do {
+///        ...
+///        if (!slicer.within_budget()) { continue; }
+///        ...
+///      } while (slicer.next_slice());
 class Slicer {
 private:
   struct Branch {
     bool execute;
     bool flip;
+
+    // execute both branches
+    bool merge;
+
+    // has the location ever written to the dependency cone?
+    bool is_relevant;
+
+    // has an irrelevant "then" or "else" block been recorded?
+    bool has_then;
+    bool has_else;
+
+    // never flip
+    bool pin;
+    bool required;
+  };
+
+  struct Decision {
+    bool then_execute;
+    bool else_execute;
+  };
+
+  // Recorded block of a branch location, nullptr for an empty block
+  struct BranchBlock {
+    Location loc;
+    bool is_then;
+    std::shared_ptr<Block> block_ptr;
   };
 
   const unsigned m_slice_freq;
+  const bool m_relevant_only;
+
+  // zero if and only if slicing is not budget-driven
+  const unsigned long long m_budget;
+
   typedef std::map<Location, Branch> BranchMap;
   BranchMap m_branch_map;
   unsigned m_slice_count;
-  std::stack<bool> m_branch_execute_stack;
+  std::stack<Decision> m_branch_decision_stack;
+  std::forward_list<BranchBlock> m_branch_blocks;
+
+  // record the current slice again?
+  bool m_retry;
+
+  // branch locations executed in the current slice
+  std::set<Location> m_executed_locs;
+
+  // hand off the given unexplored slices to another Slicer?
+  std::function<bool(const BranchPins&)> m_split_fn;
+
+  void record_branch_block(Location loc, bool is_then,
+    const std::shared_ptr<Block>& block_ptr) {
+
+    if (m_relevant_only || 0 < m_budget) {
+      const BranchBlock branch_block = {loc, is_then, block_ptr};
+      m_branch_blocks.push_front(branch_block);
+    }
+  }
+
+  // Merges all branch locations whose blocks are irrelevant to the error and
+  // expect conditions in the recorded slice
+  void merge_irrelevant_branches() {
+    std::forward_list<std::shared_ptr<Event>> event_ptrs;
+    Threads::filter(event_ptrs);
+    const DependencyCone cone(Threads::property_event_ptrs(), event_ptrs);
+
+    for (const BranchBlock& branch_block : m_branch_blocks) {
+      Branch& branch = m_branch_map.at(branch_block.loc);
+      if (branch.merge || branch.pin) {
+        continue;
+      }
+
+      if (branch_block.block_ptr &&
+          cone.is_relevant(*branch_block.block_ptr, !branch_block.is_then)) {
+        branch.is_relevant = true;
+      } else if (branch_block.is_then) {
+        branch.has_then = true;
+      } else {
+        branch.has_else = true;
+      }
+    }
+
+    for (BranchMap::reference branch_map_value : m_branch_map) {
+      Branch& branch = branch_map_value.second;
+      if (!branch.is_relevant && branch.has_then && branch.has_else &&
+          !branch.pin) {
+        branch.merge = true;
+      }
+    }
+  }
+
+  // Offers the unexplored side of the lowest branch location that has not
+  // been flipped yet, unless it is flip_loc, i.e. the location that is
+  // about to be flipped anyway. If the offer is taken, the location is
+  // pinned to the side that is being explored.
+  void split(Location flip_loc) {
+    BranchPins split_pins(pins());
+    for (BranchMap::reference branch_map_value : m_branch_map) {
+      Branch& branch = branch_map_value.second;
+      if (branch.merge || branch.pin) {
+        continue;
+      }
+
+      // the other side of a flipped location has been explored together
+      // with both sides of every higher location
+      if (branch.flip) {
+        const BranchPin flip_pin = {branch_map_value.first, branch.execute,
+          false};
+        split_pins.push_back(flip_pin);
+        continue;
+      }
+
+      if (branch_map_value.first == flip_loc) {
+        return;
+      }
+
+      const BranchPin split_pin = {branch_map_value.first, !branch.execute,
+        true};
+      split_pins.push_back(split_pin);
+      if (m_split_fn(split_pins)) {
+        branch.pin = true;
+      }
+      return;
+    }
+  }
 
 public:
   /// If the argument is zero, the series-parallel DAG is never sliced
-  Slicer(unsigned slice_freq = 0) :
+
+  /// \param relevant_only merge branch locations that cannot affect any
+  ///                      error or expect condition
+  Slicer(unsigned slice_freq = 0, bool relevant_only = false) :
     m_slice_freq(slice_freq),
+    m_relevant_only(relevant_only),
+    m_budget(0),
+    m_branch_map(),
+    m_slice_count(1),
+    m_branch_decision_stack(),
+    m_branch_blocks(),
+    m_retry(false),
+    m_executed_locs(),
+    m_split_fn() {}
+
+  /// Merge every branch location until the slice exceeds the budget
+
+  /// \pre 0 < budget.size
+  Slicer(SliceBudget budget, bool relevant_only = false) :
+    m_slice_freq(MAX_SLICE_FREQ),
+    m_relevant_only(relevant_only),
+    m_budget(budget.size),
     m_branch_map(),
     m_slice_count(1),
-    m_branch_execute_stack() {}
+    m_branch_decision_stack(),
+    m_branch_blocks(),
+    m_retry(false),
+    m_executed_locs(),
+    m_split_fn() {
+
+    assert(0 < m_budget);
+  }
 
   /// Number of slices made
   unsigned slice_count() const {
@@ -97,17 +284,33 @@ public:
       return true;
     }
 
-    bool execute = false;
+    m_executed_locs.insert(loc);
+
+    Decision decision = {false, true};
     const BranchMap::iterator branch_it(m_branch_map.find(loc));
     if (branch_it == m_branch_map.cend()) {
-      const Branch new_branch = {execute, false};
+      const bool merge = 0 < m_budget;
+      const Branch new_branch = {false, false, merge, false, false, false,
+        false, false};
       m_branch_map.insert(BranchMap::value_type(loc, new_branch));
+      decision.then_execute = merge;
+    } else if (branch_it->second.merge) {
+      decision.then_execute = true;
     } else {
-      execute = branch_it->second.execute;
+      decision.then_execute = branch_it->second.execute;
+      decision.else_execute = !decision.then_execute;
     }
 
-    m_branch_execute_stack.push(execute);
-    return execute;
+    if (decision.then_execute) {
+      record_branch_block(loc, true,
+        Threads::slice_current_block_ptr(ThisThread::thread_id()));
+    } else {
+      // the "else" block is empty unless begin_else_branch() is called
+      record_branch_block(loc, false, nullptr);
+    }
+
+    m_branch_decision_stack.push(decision);
+    return decision.then_execute;
   }
 
   /// Begin optional block
@@ -125,7 +328,12 @@ public:
       return true;
     }
 
-    return !m_branch_execute_stack.top();
+    const Decision& decision = m_branch_decision_stack.top();
+    if (decision.else_execute) {
+      record_branch_block(loc, false,
+        Threads::slice_current_block_ptr(ThisThread::thread_id()));
+    }
+    return decision.else_execute;
   }
 
   /// Demarcate the end of a conditional "then" and an optional "else" branch
@@ -136,20 +344,164 @@ public:
     ThisThread::end_branch();
 
     if (m_slice_freq > 0) {
-      m_branch_execute_stack.pop();
+      m_branch_decision_stack.pop();
     }
   }
 
+  /// Is the estimated formula size of the recorded slice within budget?
+
+  /// If the return value is false, the merged branch location with the most
+  /// recorded events is sliced from now on, the current slice is discarded
+  /// with Threads::discard(), and next_slice() records it again. In this
+  /// case, the encoders of the discarded slice must not be checked.
+  ///
+  /// The return value is always true if the slice is not budget-driven or
+  /// if there is no merged branch location left to slice.
+  bool within_budget() {
+    if (m_budget == 0) {
+      return true;
+    }
+
+    std::forward_list<std::shared_ptr<Event>> event_ptrs;
+    Threads::filter(event_ptrs);
+
+    ZoneRelation<Event> zone_relation;
+    for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+      if (!event_ptr->zone().is_bottom()) {
+        zone_relation.relate(event_ptr);
+      }
+    }
+
+    if (Z3OrderEncoderC0::estimate(zone_relation) <= m_budget) {
+      return true;
+    }
+
+    // number of events in the blocks of each merged branch location
+    std::map<Location, size_t> size_map;
+    for (const BranchBlock& branch_block : m_branch_blocks) {
+      const Branch& branch = m_branch_map.at(branch_block.loc);
+      if (!branch.merge || !branch_block.block_ptr ||
+          (branch.has_then && branch.has_else && !branch.is_relevant)) {
+        continue;
+      }
+
+      std::forward_list<std::shared_ptr<Event>> block_event_ptrs;
+      branch_block.block_ptr->filter(block_event_ptrs, !branch_block.is_then);
+      size_map[branch_block.loc] += std::distance(block_event_ptrs.cbegin(),
+        block_event_ptrs.cend());
+    }
+
+    if (size_map.empty()) {
+      return true;
+    }
+
+    std::map<Location, size_t>::const_iterator max_iter(size_map.cbegin());
+    for (std::map<Location, size_t>::const_iterator iter(size_map.cbegin());
+         iter != size_map.cend(); iter++) {
+      if (max_iter->second < iter->second) {
+        max_iter = iter;
+      }
+    }
+
+    Branch& branch = m_branch_map.at(max_iter->first);
+    branch.merge = false;
+    branch.execute = false;
+    branch.flip = false;
+
+    m_branch_blocks.clear();
+    m_retry = true;
+    Threads::discard();
+    return false;
+  }
+
+  /// Pinned branch locations
+  BranchPins pins() const {
+    BranchPins branch_pins;
+    for (BranchMap::const_reference branch_map_value : m_branch_map) {
+      const Branch& branch = branch_map_value.second;
+      if (branch.pin) {
+        const BranchPin branch_pin = {branch_map_value.first, branch.execute,
+          branch.required};
+        branch_pins.push_back(branch_pin);
+      }
+    }
+    return branch_pins;
+  }
+
+  /// Forget all branch locations except the given pinned ones
+
+  /// The next slice is the first one in which all the branch locations are
+  /// either pinned or take their "else" branch.
+  ///
+  /// \pre next_slice() has returned false or no slice has been recorded yet
+  void restart(const BranchPins& branch_pins) {
+    assert(m_branch_decision_stack.empty());
+
+    m_branch_map.clear();
+    for (const BranchPin& branch_pin : branch_pins) {
+      const Branch branch = {branch_pin.execute, false, false, false, false,
+        false, true, branch_pin.required};
+      m_branch_map.insert(BranchMap::value_type(branch_pin.loc, branch));
+    }
+
+    m_branch_blocks.clear();
+    m_executed_locs.clear();
+    m_retry = false;
+  }
+
+  /// Install a predicate that decides whether to split off unexplored slices
+
+  /// Whenever next_slice() looks for another slice, it offers the largest
+  /// set of slices that it has not explored yet, if any, to the predicate:
+  /// those that take the unexplored side of the lowest branch location that
+  /// has not been flipped. The offer is described by pins that are meant to
+  /// be passed to a restart() of another Slicer. If the predicate returns
+  /// true, it is responsible for exploring the offered slices, and the
+  /// location is pinned to its current side in this Slicer.
+  void set_split_fn(std::function<bool(const BranchPins&)> split_fn) {
+    m_split_fn = split_fn;
+  }
+
+  /// Does the recorded slice belong to this Slicer?
+
+  /// A slice belongs to the Slicer if and only if every required pinned
+  /// branch location has been executed. Otherwise, the slice is discarded
+  /// with Threads::discard() because it has been split off to another
+  /// Slicer, which explores it without the required pins.
+  bool owns_slice() {
+    for (BranchMap::const_reference branch_map_value : m_branch_map) {
+      if (branch_map_value.second.required &&
+          m_executed_locs.count(branch_map_value.first) == 0) {
+        Threads::discard();
+        return false;
+      }
+    }
+    return true;
+  }
+
   /// Look for another slice to analyze
 
   /// \returns is there another slice to analyze?
   bool next_slice() {
+    m_executed_locs.clear();
+
+    if (m_retry) {
+      m_retry = false;
+      return true;
+    }
+
     if (m_branch_map.empty()) {
       return false;
     }
 
+    if (m_relevant_only) {
+      merge_irrelevant_branches();
+    }
+    m_branch_blocks.clear();
+
     BranchMap::reverse_iterator rev_it(m_branch_map.rbegin());
-    while (rev_it != m_branch_map.rend() && rev_it->second.flip) {
+    while (rev_it != m_branch_map.rend() && (rev_it->second.flip ||
+        rev_it->second.merge || rev_it->second.pin)) {
       // as we flip higher up branches we want to revisit
       // both directions of any lower branches
       rev_it->second.flip = false;
@@ -160,6 +512,10 @@ public:
       return false;
     }
 
+    if (m_split_fn) {
+      split(rev_it->first);
+    }
+
     rev_it->second.flip = true;
     rev_it->second.execute = !rev_it->second.execute;
 
@@ -0,0 +1,170 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_SUMMARY_H_
+#define LIBSE_CONCURRENT_SUMMARY_H_
+
+#include <vector>
+#include <functional>
+
+#include "concurrent/cloner.h"
+#include "concurrent/thread.h"
+#include "concurrent/var.h"
+
+namespace se {
+
+/// Function that is recorded once and replayed at every call site
+
+/// The first call records the function in a separate slice. This recording
+/// is then cloned at every call site, including the first one, with fresh
+/// events: the shared memory accesses are ordered like any other events of
+/// the calling thread, and the thread-local dataflow reads from the
+/// arguments of the call site instead of those of the recording.
+///
+/// Every parameter is a thread-local variable that is passed by reference,
+/// so that the function can also return values through it. The function
+/// must only access the local variables of its callers through these
+/// parameters, and must not depend on ThisThread::thread_id(). Since its
+/// branches are recorded only once, the decisions of a Slicer must be the
+/// same at every call site, which is the case within one slice.
+///
+/// A function that spawns or joins threads is called as usual instead.
+///
+/// Example:
+///
+///      se::Summary<int> push([](se::LocalVar<int>& x) {
+///        top = top + x;
+///      });
+///
+///      se::LocalVar<int> x(1);
+///      push(x);
+///      push(x);
+template<typename... Args>
+class Summary {
+private:
+  typedef std::function<void(LocalVar<Args>&...)> Function;
+  typedef std::vector<std::shared_ptr<Event>> EventPtrs;
+
+  const Function m_function;
+
+  // nullptr if the function has not been recorded yet
+  std::unique_ptr<Threads::Recording> m_recording_ptr;
+  unsigned long long m_recording_id;
+
+  // events of every parameter before and after the recording
+  EventPtrs m_begin_read_event_ptrs;
+  EventPtrs m_end_read_event_ptrs;
+  EventPtrs m_end_write_event_ptrs;
+
+  unsigned long long m_replay_count;
+
+  template<typename T>
+  static std::shared_ptr<Event> read_event_ptr(const LocalVar<T>& var) {
+    return var.read_event_ptr();
+  }
+
+  template<typename T>
+  static std::shared_ptr<Event> write_event_ptr(const LocalVar<T>& var) {
+    return var.m_var.direct_write_event_ptr();
+  }
+
+  template<typename T>
+  static void set_event_ptrs(LocalVar<T>& var,
+    const std::shared_ptr<Event>& write_event_ptr,
+    const std::shared_ptr<Event>& read_event_ptr) {
+
+    var.m_var.set_direct_write_event_ptr(
+      std::static_pointer_cast<DirectWriteEvent<T>>(write_event_ptr));
+    var.m_local_read.set_read_event_ptr(
+      std::static_pointer_cast<ReadEvent<T>>(read_event_ptr));
+  }
+
+  template<typename T>
+  void bind(LocalVar<T>& var, size_t index, EventCloner& cloner) const {
+    cloner.bind(m_begin_read_event_ptrs[index], read_event_ptr(var));
+  }
+
+  // Arguments that have been assigned by the function read from the clones
+  template<typename T>
+  void assign(LocalVar<T>& var, size_t index, EventCloner& cloner) const {
+    if (m_end_read_event_ptrs[index] != m_begin_read_event_ptrs[index]) {
+      set_event_ptrs(var, cloner.event_ptr(m_end_write_event_ptrs[index]),
+        cloner.event_ptr(m_end_read_event_ptrs[index]));
+    }
+  }
+
+  void record(LocalVar<Args>&... args) {
+    const EventPtrs begin_write_event_ptrs = {write_event_ptr(args)...};
+    m_begin_read_event_ptrs = {read_event_ptr(args)...};
+
+    const Function& f = m_function;
+    m_recording_ptr = Threads::record([&f, &args...]() { f(args...); });
+    m_recording_id = Threads::recording_id();
+
+    m_end_read_event_ptrs = {read_event_ptr(args)...};
+    m_end_write_event_ptrs = {write_event_ptr(args)...};
+
+    // the recording itself leaves the arguments unchanged
+    size_t index = 0;
+    const int expansion[] = {0, (set_event_ptrs(args,
+      begin_write_event_ptrs[index], m_begin_read_event_ptrs[index]),
+      ++index, 0)...};
+    (void) expansion;
+  }
+
+  void replay(LocalVar<Args>&... args) {
+    const Threads::Recording& recording = *m_recording_ptr;
+    EventCloner cloner(ThisThread::thread_id(), ThisThread::path_condition_ptr(),
+      recording.begin_event_id, recording.end_event_id,
+      recording.begin_atom, recording.end_atom);
+
+    size_t index = 0;
+    const int bind_expansion[] = {0, (bind(args, index, cloner), ++index, 0)...};
+    (void) bind_expansion;
+
+    Threads::replay(recording, cloner);
+
+    index = 0;
+    const int assign_expansion[] = {0,
+      (assign(args, index, cloner), ++index, 0)...};
+    (void) assign_expansion;
+
+    m_replay_count++;
+  }
+
+public:
+  explicit Summary(Function f) :
+    m_function(std::move(f)),
+    m_recording_ptr(nullptr),
+    m_recording_id(0),
+    m_begin_read_event_ptrs(),
+    m_end_read_event_ptrs(),
+    m_end_write_event_ptrs(),
+    m_replay_count(0) {}
+
+  Summary(const Summary&) = delete;
+
+  /// Number of calls that have been replayed rather than executed
+  unsigned long long replay_count() const {
+    return m_replay_count;
+  }
+
+  /// Record the function unless it has been recorded since the last
+  /// Threads::reset(), and then replay it with the given arguments
+  void operator()(LocalVar<Args>&... args) {
+    if (!m_recording_ptr || m_recording_id != Threads::recording_id()) {
+      record(args...);
+    }
+
+    if (m_recording_ptr->is_replayable) {
+      replay(args...);
+    } else {
+      m_function(args...);
+    }
+  }
+};
+
+}
+
+#endif
@@ -6,17 +6,24 @@
 #define LIBSE_CONCURRENT_THREAD_H_
 
 #include <stack>
+#include <atomic>
+#include <vector>
+#include <iterator>
+#include <algorithm>
 #include <unordered_map>
 
 #include "concurrent/zone.h"
 #include "concurrent/event.h"
 #include "concurrent/encoder_c0.h"
 #include "concurrent/slice.h"
+#include "concurrent/cone.h"
+#include "concurrent/cloner.h"
 
 namespace se {
 
 class Thread;
 class Slice;
+class Session;
 
 namespace ThisThread {
   /// Current thread identifier
@@ -43,8 +50,23 @@ namespace ThisThread {
   void end_branch();
 }
 
+/// Begin an atomic section of the current thread
+
+/// No other thread accesses the memory that the events of the section
+/// access while the section executes. Every atomic_begin() must be matched
+/// by an atomic_end() in the same branch of the same thread. Nested atomic
+/// sections are part of the outermost one.
+void atomic_begin();
+
+/// End the atomic section of the current thread, see atomic_begin()
+void atomic_end();
+
 extern Encoders& global_encoders();
 
+/// Tag that spawns a Thread from the recording of an earlier one
+struct CachedRecording {};
+constexpr CachedRecording cached_recording = CachedRecording();
+
 /// Symbolic thread for the analysis of concurrent C++ code
 class Thread {
 private:
@@ -55,7 +77,9 @@ private:
   typedef std::forward_list<ConditionPtr> ConditionPtrs;
 
   static const std::shared_ptr<ReadInstr<bool>> s_true_condition_ptr;
-  static ThreadId s_next_thread_id;
+
+  // \internal counter of the current Session
+  static ThreadId& next_thread_id();
 
   // unique thread identifier
   const ThreadId m_thread_id;
@@ -71,14 +95,18 @@ private:
   ConditionPtrs m_condition_ptrs;
   std::stack<ConditionPtr> m_path_condition_ptr_cache;
 
+  // number of atomic sections that have begun but not ended yet
+  unsigned m_atomic_depth;
+
   // \internal called by Threads::begin_thread()
   Thread(Thread* parent_thread_ptr) :
-    m_thread_id(s_next_thread_id++),
+    m_thread_id(next_thread_id()++),
     m_parent_thread_ptr(parent_thread_ptr),
     m_send_event_ptr(nullptr),
     m_condition_ptrs_size(0),
     m_condition_ptrs(),
-    m_path_condition_ptr_cache() {}
+    m_path_condition_ptr_cache(),
+    m_atomic_depth(0) {}
 
   Thread* parent_thread_ptr() const {
     return m_parent_thread_ptr;
@@ -138,13 +166,35 @@ public:
   template<typename Function, typename... Args>
   explicit Thread(Function&& f, Args&&... args);
 
+  /// Symbolically spawn `f()` without executing it again
+
+  /// \param f non-member function to be executed as a new symbolic thread
+  ///
+  /// The first spawn of `f` since the last Threads::reset() records it
+  /// once, and every such spawn, including the first one, appends clones
+  /// of the recorded events with fresh identifiers. This is sound if every
+  /// run of `f` records the same events and branches except for their
+  /// identifiers. In particular, `f` must not depend on the identifier of
+  /// its thread, as Mutex does, nor on values that change between spawns.
+  ///
+  /// If `f` spawns or joins threads, it is executed as usual instead.
+  ///
+  /// Example:
+  ///
+  ///      se::Thread t1(se::cached_recording, f);
+  ///      se::Thread t2(se::cached_recording, f);
+  ///
+  /// \pre: There must exist a main thread
+  Thread(CachedRecording, void (*f)());
+
   Thread(const Thread&) = delete;
   Thread(Thread&& other) :
     m_thread_id(other.m_thread_id),
     m_parent_thread_ptr(other.m_parent_thread_ptr),
     m_send_event_ptr(std::move(other.m_send_event_ptr)),
     m_condition_ptrs_size(other.m_condition_ptrs_size),
-    m_condition_ptrs(std::move(other.m_condition_ptrs)) {}
+    m_condition_ptrs(std::move(other.m_condition_ptrs)),
+    m_atomic_depth(other.m_atomic_depth) {}
 
   ThreadId thread_id() const {
     return m_thread_id;
@@ -154,6 +204,9 @@ public:
   void begin_else();
   void end_branch();
 
+  void atomic_begin();
+  void atomic_end();
+
   std::shared_ptr<ReadInstr<bool>> path_condition_ptr();
 
   template<typename T>
@@ -168,18 +221,30 @@ public:
   void join() noexcept;
 };
 
-/// \internal Thread helper singleton
+/// \internal Thread helper singleton of the current Session
 class Threads {
 private:
-  static Threads s_singleton;
+  friend class Session;
+
+  // \internal threads of the current Session
+  static Threads& singleton();
 
   std::stack<Thread> m_thread_stack;
 
   // nullptr if and only if this is the main thread
   Thread* m_current_thread_ptr;
 
-  // must only be accessed before Encoders solver is deallocated
-  std::forward_list<smt::UnsafeTerm> m_error_exprs;
+  // Error or expect condition that is encoded by encode(Encoders&) so that
+  // every value has been recorded by the time the condition is encoded
+  struct Property {
+    std::shared_ptr<ReadInstr<bool>> condition_ptr;
+
+    // nullptr if the condition is unconditional
+    std::shared_ptr<ReadInstr<bool>> path_condition_ptr;
+  };
+
+  std::forward_list<Property> m_errors;
+  std::forward_list<Property> m_expects;
 
   // per-thread series-parallel graph where each vertex is an event pointer
   typedef std::unordered_map<ThreadId, Slice> SliceMap;
@@ -188,15 +253,27 @@ private:
   ThreadId m_main_thread_id;
   std::forward_list<std::shared_ptr<Event>> m_main_init_event_ptrs;
 
+  // read events in error and expect conditions
+  std::forward_list<std::shared_ptr<Event>> m_property_event_ptrs;
+
+  // unique across all sessions, see recording_id()
+  static std::atomic<unsigned long long> s_next_recording_id;
+  unsigned long long m_recording_id;
+
   Threads() :
     m_thread_stack(),
     m_current_thread_ptr(nullptr),
-    m_error_exprs(),
+    m_errors(),
+    m_expects(),
     m_slice_map(),
     m_main_thread_id(0),
-    m_main_init_event_ptrs() {
+    m_main_init_event_ptrs(),
+    m_property_event_ptrs(),
+    m_recording_id(s_next_recording_id++),
+    m_thread_recording_ptrs(),
+    m_symmetric_threads() {
 
-    internal_reset(0, 0);
+    m_slice_map[m_main_thread_id].append_all(m_main_init_event_ptrs);
   }
 
   // Clears the entire thread stack and restarts recording the main thread
@@ -209,7 +286,12 @@ private:
     }
 
     m_current_thread_ptr = nullptr;
-    assert(m_error_exprs.empty());
+    assert(m_errors.empty());
+    m_expects.clear();
+    m_property_event_ptrs.clear();
+    m_recording_id = s_next_recording_id++;
+    m_thread_recording_ptrs.clear();
+    m_symmetric_threads.clear();
 
     m_slice_map.clear();
     m_slice_map[m_main_thread_id].append_all(m_main_init_event_ptrs);
@@ -217,121 +299,844 @@ private:
 
   // thread_ptr can be nullptr
   static void set_current_thread_ptr(Thread* thread_ptr) {
-    s_singleton.m_current_thread_ptr = thread_ptr;
+    singleton().m_current_thread_ptr = thread_ptr;
   }
 
-  static Clock internal_encode_spo(const std::shared_ptr<Block>& block_ptr,
-    const Clock& earlier_clock,
+  // Clocks of the last events of a block, i.e. the next event in program
+  // order happens after all of them. Every clock is paired with its event
+  // so that the clocks of branches without shared memory accesses can be
+  // merged without duplicates; the epoch has no event.
+  typedef std::vector<std::pair<const Event*, Clock>> Frontier;
+
+  // Atomic region or critical section of a thread, see RegionEvent
+  struct Region {
+    const RegionEvent* begin_event_ptr;
+
+    // nullptr until the end of the region has been encoded
+    const RegionEvent* end_event_ptr;
+
+    // memory that is accessed by the events in an atomic region, or nullptr
+    // if the region is a critical section
+    std::unique_ptr<Zone> zone_ptr;
+  };
+  typedef std::vector<Region> Regions;
+
+  static void internal_merge(const Frontier& frontier, Frontier& merge) {
+    for (Frontier::const_reference clock : frontier) {
+      bool is_new = true;
+      for (Frontier::const_reference merge_clock : merge) {
+        if (clock.first == merge_clock.first) {
+          is_new = false;
+          break;
+        }
+      }
+      if (is_new) {
+        merge.push_back(clock);
+      }
+    }
+  }
+
+  // Ends the last critical section of the same thread and mutex
+  static void internal_unlock(const RegionEvent& unlock_event,
+    Regions& critical_sections) {
+
+    for (Regions::reverse_iterator iter = critical_sections.rbegin();
+         iter != critical_sections.rend(); ++iter) {
+      const RegionEvent& lock_event = *iter->begin_event_ptr;
+      if (!iter->end_event_ptr &&
+          lock_event.thread_id() == unlock_event.thread_id() &&
+          lock_event.mutex_ptr() == unlock_event.mutex_ptr()) {
+        iter->end_event_ptr = &unlock_event;
+        return;
+      }
+    }
+
+    // every unlock() has been preceded by a lock()
+    assert(false);
+  }
+
+  // The atomic regions are appended to regions, and the critical sections
+  // to critical_sections.
+  static Frontier internal_encode_spo(const std::shared_ptr<Block>& block_ptr,
+    const Frontier& earlier_frontier,
     ZoneRelation<Event>& zone_relation,
+    Regions& regions,
+    Regions& critical_sections,
     Encoders& encoders) {
 
     const ValueEncoder value_encoder;
 
-    Clock inner_clock(earlier_clock);
+    Frontier inner_frontier(earlier_frontier);
     if (!block_ptr->body().empty()) {
       // Consider changing Block::body() to return an ordered set if it would
       // simplify the treatment of local events (below, currently excluded).
       const std::forward_list<std::shared_ptr<Event>>& body = block_ptr->body();
 
-      Clock body_clock(inner_clock);
       for (const std::shared_ptr<Event>& body_event_ptr : body) {
         const Event& body_event = *body_event_ptr;
-
         if (body_event.is_write()) {
           const smt::UnsafeTerm equality_expr(body_event.encode_eq(value_encoder, encoders));
           encoders.solver.unsafe_add(equality_expr);
         }
   
-        if (!body_event.zone().is_bottom()) {
+        if (body_event.is_region()) {
+          const RegionEvent& region_event =
+            static_cast<const RegionEvent&>(body_event);
+          if (region_event.mutex_ptr()) {
+            if (region_event.is_begin()) {
+              critical_sections.push_back(Region{&region_event, nullptr,
+                nullptr});
+            } else {
+              internal_unlock(region_event, critical_sections);
+            }
+          } else if (region_event.is_begin()) {
+            regions.push_back(Region{&region_event, nullptr,
+              std::unique_ptr<Zone>(new Zone())});
+          } else {
+            assert(!regions.empty() && !regions.back().end_event_ptr);
+            regions.back().end_event_ptr = &region_event;
+          }
+        } else if (!body_event.zone().is_bottom()) {
           zone_relation.relate(body_event_ptr);
 
-          Clock next_body_clock(encoders.clock(body_event));
-          encoders.solver.add(body_clock.happens_before(next_body_clock));
-          body_clock = next_body_clock;
+          if (!regions.empty() && !regions.back().end_event_ptr) {
+            Region& region = regions.back();
+            region.zone_ptr.reset(new Zone(
+              region.zone_ptr->join(body_event.zone())));
+          }
+        }
+
+        if (body_event.is_region() || !body_event.zone().is_bottom()) {
+          const Clock next_body_clock(encoders.clock(body_event));
+          for (Frontier::const_reference body_clock : inner_frontier) {
+            encoders.solver.unsafe_add(
+              body_clock.second.happens_before(next_body_clock));
+          }
+          inner_frontier.clear();
+          inner_frontier.emplace_back(&body_event, next_body_clock);
+        }
+      }
+    }
+
+    for (const std::shared_ptr<Block>& inner_block_ptr :
+      block_ptr->inner_block_ptrs()) {
+
+      Frontier then_frontier(internal_encode_spo(inner_block_ptr,
+        inner_frontier, zone_relation, regions, critical_sections, encoders));
+      const std::shared_ptr<Block>& inner_else_block_ptr(
+        inner_block_ptr->else_block_ptr());
+      if (inner_else_block_ptr) {
+        Frontier else_frontier(internal_encode_spo(inner_else_block_ptr,
+          inner_frontier, zone_relation, regions, critical_sections, encoders));
+        inner_frontier.clear();
+        if (encoders.options().join_clocks) {
+          // join clocks keep every frontier a singleton
+          assert(then_frontier.size() == 1 && else_frontier.size() == 1);
+          inner_frontier.emplace_back(nullptr, encoders.join_clocks(
+            then_frontier.front().second, else_frontier.front().second));
+        } else {
+          internal_merge(then_frontier, inner_frontier);
+          internal_merge(else_frontier, inner_frontier);
+        }
+      } else {
+        inner_frontier = std::move(then_frontier);
+      }
+    }
+
+    return inner_frontier;
+  }
+
+  static smt::UnsafeTerm internal_condition(const Event& event,
+    const ReadInstrEncoder& read_encoder, Encoders& encoders) {
+
+    if (event.condition_ptr()) {
+      return event.condition_ptr()->encode(read_encoder, encoders);
+    }
+    return smt::literal<smt::Bool>(true);
+  }
+
+  // Events of other threads that access the memory of an atomic region
+  // happen either before or after the region
+  static void internal_encode_regions(const Regions& regions,
+    const ZoneRelation<Event>& zone_relation, Encoders& encoders) {
+
+    const ReadInstrEncoder read_encoder;
+    for (const Region& region : regions) {
+      const Zone& zone = *region.zone_ptr;
+      if (zone.is_bottom()) {
+        continue;
+      }
+
+      const Event& begin_event = *region.begin_event_ptr;
+      const Clock begin_clock(encoders.clock(begin_event));
+      const Clock end_clock(encoders.clock(*region.end_event_ptr));
+      const smt::UnsafeTerm region_condition(
+        internal_condition(begin_event, read_encoder, encoders));
+
+      for (const std::shared_ptr<Event>& event_ptr : zone_relation.event_ptrs()) {
+        const Event& event = *event_ptr;
+        if (event.thread_id() == begin_event.thread_id() ||
+            event.zone().meet(zone).is_bottom()) {
+          continue;
+        }
+
+        const Clock clock(encoders.clock(event));
+        encoders.solver.unsafe_add(smt::implies(region_condition and
+          internal_condition(event, read_encoder, encoders),
+          clock.happens_before(begin_clock) or end_clock.happens_before(clock)));
+      }
+    }
+  }
+
+  // Does the critical section end before the other one begins? A critical
+  // section whose mutex is never unlocked precedes no other one.
+  static smt::UnsafeTerm internal_precedes(const Region& x, const Region& y,
+    Encoders& encoders) {
+
+    if (!x.end_event_ptr) {
+      return smt::literal<smt::Bool>(false);
+    }
+    return encoders.clock(*x.end_event_ptr).happens_before(
+      encoders.clock(*y.begin_event_ptr));
+  }
+
+  // Critical sections of the same mutex in different threads do not overlap
+  static void internal_encode_critical_sections(
+    const Regions& critical_sections, Encoders& encoders) {
+
+    const ReadInstrEncoder read_encoder;
+    for (Regions::const_iterator x = critical_sections.cbegin();
+         x != critical_sections.cend(); ++x) {
+      const RegionEvent& x_lock_event = *x->begin_event_ptr;
+      const smt::UnsafeTerm x_condition(
+        internal_condition(x_lock_event, read_encoder, encoders));
+
+      for (Regions::const_iterator y = std::next(x);
+           y != critical_sections.cend(); ++y) {
+        const RegionEvent& y_lock_event = *y->begin_event_ptr;
+        if (x_lock_event.thread_id() == y_lock_event.thread_id() ||
+            x_lock_event.mutex_ptr() != y_lock_event.mutex_ptr()) {
+          continue;
         }
+
+        encoders.solver.unsafe_add(smt::implies(x_condition and
+          internal_condition(y_lock_event, read_encoder, encoders),
+          internal_precedes(*x, *y, encoders) or
+          internal_precedes(*y, *x, encoders)));
       }
+    }
+  }
 
-      inner_clock = body_clock;
+  // Appends clones of the block's events and replays its inner blocks
+  static void internal_replay(const Block& block, EventCloner& cloner) {
+    const ThreadId thread_id = cloner.thread_id();
+    for (const std::shared_ptr<Event>& event_ptr : block.body()) {
+      slice_append(thread_id, cloner.event_ptr(event_ptr));
+    }
+
+    for (const std::shared_ptr<Block>& inner_block_ptr :
+      block.inner_block_ptrs()) {
+
+      if (!inner_block_ptr->condition_ptr()) {
+        internal_replay(*inner_block_ptr, cloner);
+        continue;
+      }
+
+      // the condition's read events have been cloned in the outer block
+      singleton().m_slice_map[thread_id].begin_then_block(
+        cloner.instr_ptr(inner_block_ptr->condition_ptr()));
+      internal_replay(*inner_block_ptr, cloner);
+
+      const std::shared_ptr<Block>& else_block_ptr(
+        inner_block_ptr->else_block_ptr());
+      if (else_block_ptr) {
+        slice_begin_else(thread_id);
+        internal_replay(*else_block_ptr, cloner);
+      }
+      slice_end_branch(thread_id);
+    }
+  }
+
+  static Property internal_clone(const Property& property,
+    EventCloner& cloner) {
+
+    const Property clone = {cloner.instr_ptr(property.condition_ptr),
+      cloner.condition_ptr(property.path_condition_ptr)};
+    clone.condition_ptr->filter(singleton().m_property_event_ptrs);
+    return clone;
+  }
+
+  // Appends the read events of the property's conditions
+  static void internal_filter(const Property& property,
+    std::forward_list<std::shared_ptr<Event>>& event_ptrs) {
+
+    property.condition_ptr->filter(event_ptrs);
+    if (property.path_condition_ptr) {
+      property.path_condition_ptr->filter(event_ptrs);
+    }
+  }
+
+  // Root of x in a union-find forest
+  static size_t internal_find(std::vector<size_t>& parents, size_t x) {
+    while (parents[x] != x) {
+      parents[x] = parents[parents[x]];
+      x = parents[x];
+    }
+    return x;
+  }
+
+  // Counts the events and joins that can have a clock, and finds the
+  // largest event identifier
+  static void internal_clock_bound(const std::shared_ptr<Block>& block_ptr,
+    unsigned long long& clock_count, EventId& max_event_id) {
+
+    for (const std::shared_ptr<Event>& body_event_ptr : block_ptr->body()) {
+      clock_count++;
+      if (max_event_id < body_event_ptr->event_id()) {
+        max_event_id = body_event_ptr->event_id();
+      }
     }
 
     for (const std::shared_ptr<Block>& inner_block_ptr :
       block_ptr->inner_block_ptrs()) {
 
-      Clock then_clock(internal_encode_spo(inner_block_ptr, inner_clock,
-        zone_relation, encoders));
+      internal_clock_bound(inner_block_ptr, clock_count, max_event_id);
       const std::shared_ptr<Block>& inner_else_block_ptr(
         inner_block_ptr->else_block_ptr());
       if (inner_else_block_ptr) {
-        Clock else_clock(internal_encode_spo(inner_else_block_ptr,
-          inner_clock, zone_relation, encoders));
-        inner_clock = encoders.join_clocks(then_clock, else_clock);
+        internal_clock_bound(inner_else_block_ptr, clock_count, max_event_id);
+        clock_count++;
+      }
+    }
+  }
+
+  // Adds all recorded events and properties to the given analysis
+  static void internal_range(RangeAnalysis& analysis) {
+    std::forward_list<std::shared_ptr<Event>> event_ptrs;
+    filter(event_ptrs);
+    for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+      analysis.add(*event_ptr);
+    }
+
+    for (const Property& expect : singleton().m_expects) {
+      internal_range(expect, analysis);
+    }
+    for (const Property& error : singleton().m_errors) {
+      internal_range(error, analysis);
+    }
+  }
+
+  static void internal_range(const Property& property, RangeAnalysis& analysis) {
+    analysis.add(*property.condition_ptr);
+    if (property.path_condition_ptr) {
+      analysis.add(*property.path_condition_ptr);
+    }
+  }
+
+  // First write event to shared memory in the unconditional blocks of a
+  // thread, nullptr if there is none
+  static const Event* internal_first_write(const std::shared_ptr<Block>& block_ptr) {
+    for (const std::shared_ptr<Event>& body_event_ptr : block_ptr->body()) {
+      const Event& body_event = *body_event_ptr;
+      if (body_event.is_write() && !body_event.is_sync() &&
+          !body_event.zone().is_bottom() && !body_event.condition_ptr()) {
+        return &body_event;
+      }
+    }
+
+    for (const std::shared_ptr<Block>& inner_block_ptr :
+      block_ptr->inner_block_ptrs()) {
+
+      if (inner_block_ptr->condition_ptr()) {
+        continue;
+      }
+
+      const Event* const event_ptr = internal_first_write(inner_block_ptr);
+      if (event_ptr) {
+        return event_ptr;
+      }
+    }
+
+    return nullptr;
+  }
+
+  // Orders the first writes of threads that are interchangeable, see
+  // EncoderOptions::break_symmetry
+  static void internal_break_symmetry(Encoders& encoders) {
+
+    const std::vector<SymmetricThread>& symmetric_threads =
+      singleton().m_symmetric_threads;
+
+    for (size_t i = 1; i < symmetric_threads.size(); i++) {
+      const SymmetricThread& x = symmetric_threads[i - 1];
+      const SymmetricThread& y = symmetric_threads[i];
+      if (!x.is_interchangeable(y)) {
+        continue;
+      }
+
+      // both threads are clones of the same recording
+      const Event* const x_event_ptr = internal_first_write(
+        slice_most_outer_block_ptr(x.thread_id));
+      const Event* const y_event_ptr = internal_first_write(
+        slice_most_outer_block_ptr(y.thread_id));
+      if (!x_event_ptr || !y_event_ptr ||
+          x_event_ptr->zone() != y_event_ptr->zone()) {
+        continue;
+      }
+
+      encoders.solver.unsafe_add(encoders.clock(*x_event_ptr).happens_before(
+        encoders.clock(*y_event_ptr)));
+    }
+  }
+
+  // Every event with a clock is in a context that is owned by its thread,
+  // see EncoderOptions::context_bound. The contexts of a thread never
+  // decrease in program order, which is the order of the event identifiers,
+  // and events of different threads that access the same memory happen in
+  // the order of their contexts.
+  static void internal_encode_contexts(const ZoneRelation<Event>& zone_relation,
+    Encoders& encoders) {
+
+    const unsigned context_bound = encoders.options().context_bound;
+    const smt::UnsafeTerm has_contexts(encoders.has_contexts());
+
+    std::unordered_map<ThreadId, std::vector<const Event*>> thread_event_ptrs;
+    for (const std::shared_ptr<Event>& event_ptr : zone_relation.event_ptrs()) {
+      thread_event_ptrs[event_ptr->thread_id()].push_back(event_ptr.get());
+    }
+
+    for (auto& thread_event_ptrs_value : thread_event_ptrs) {
+      std::vector<const Event*>& event_ptrs = thread_event_ptrs_value.second;
+      std::sort(event_ptrs.begin(), event_ptrs.end(),
+        [](const Event* x, const Event* y) {
+          return x->event_id() < y->event_id();
+        });
+
+      const smt::UnsafeTerm thread_id(encoders.context_literal(
+        thread_event_ptrs_value.first));
+      for (size_t i = 0; i < event_ptrs.size(); i++) {
+        const smt::UnsafeTerm context(encoders.context(*event_ptrs[i]));
+        if (i == 0) {
+          encoders.solver.unsafe_add(smt::implies(has_contexts,
+            not (context < encoders.context_literal(0))));
+        } else {
+          encoders.solver.unsafe_add(smt::implies(has_contexts,
+            not (context < encoders.context(*event_ptrs[i - 1]))));
+        }
+
+        for (unsigned c = 0; c <= context_bound; c++) {
+          encoders.solver.unsafe_add(smt::implies(has_contexts and
+            context == encoders.context_literal(c),
+            encoders.context_owner(c) == thread_id));
+          encoders.solver.unsafe_add(smt::implies(encoders.context_bound(c),
+            has_contexts and not (encoders.context_literal(c) < context)));
+        }
+      }
+    }
+
+    for (const std::shared_ptr<Event>& x_ptr : zone_relation.event_ptrs()) {
+      const Event& x = *x_ptr;
+      const smt::UnsafeTerm x_context(encoders.context(x));
+      for (const std::shared_ptr<Event>& y_ptr : zone_relation.event_ptrs()) {
+        const Event& y = *y_ptr;
+        if (x.thread_id() == y.thread_id() ||
+            x.zone().meet(y.zone()).is_bottom()) {
+          continue;
+        }
+
+        encoders.solver.unsafe_add(smt::implies(has_contexts and
+          x_context < encoders.context(y),
+          encoders.clock(x).happens_before(encoders.clock(y))));
+      }
+    }
+  }
+
+  // Disjunction of the given error conditions
+  static smt::UnsafeTerm internal_encode_errors(
+    const std::forward_list<Property>& errors, Encoders& encoders) {
+
+    const ReadInstrEncoder read_encoder;
+    smt::UnsafeTerm some_error_expr(smt::literal<smt::Bool>(false));
+    for (const Property& error : errors) {
+      smt::UnsafeTerm error_expr(
+        error.condition_ptr->encode(read_encoder, encoders));
+      if (error.path_condition_ptr) {
+        error_expr = error_expr and
+          error.path_condition_ptr->encode(read_encoder, encoders);
+      }
+      some_error_expr = some_error_expr or error_expr;
+    }
+    return some_error_expr;
+  }
+
+  // Encodes all recorded events and the given properties
+  static bool internal_encode(const std::forward_list<Property>& errors,
+    const std::forward_list<Property>& expects, Encoders& encoders) {
+
+    ZoneRelation<Event> zone_relation;
+    const Z3OrderEncoderC0 order_encoder;
+
+    if (encoders.options().narrow_clocks) {
+      // one more clock for the epoch
+      unsigned long long clock_count = 1;
+      EventId max_event_id = 0;
+      for (SliceMap::const_reference slice_map_value : singleton().m_slice_map) {
+        internal_clock_bound(slice_map_value.second.most_outer_block_ptr(),
+          clock_count, max_event_id);
+      }
+      // contexts and their owners are encoded like clocks
+      encoders.bound_clocks(std::max<unsigned long long>({clock_count,
+        max_event_id, encoders.options().context_bound,
+        Thread::next_thread_id()}));
+    }
+
+    const Clock epoch_clock(encoders.any_clock("epoch"));
+
+    if (encoders.options().narrow_values &&
+        encoders.options().theory == Theory::BV) {
+      RangeAnalysis analysis;
+      internal_range(analysis);
+      analysis.solve();
+      encoders.bound_values(analysis);
+    }
+
+    Regions regions;
+    Regions critical_sections;
+    for (SliceMap::const_reference slice_map_value : singleton().m_slice_map) {
+      const std::shared_ptr<Block> most_outer_block_ptr =
+        slice_map_value.second.most_outer_block_ptr();
+      const Frontier epoch_frontier(1, std::make_pair(nullptr, epoch_clock));
+      internal_encode_spo(most_outer_block_ptr, epoch_frontier, zone_relation,
+        regions, critical_sections, encoders);
+
+      // every atomic_begin() has been matched by an atomic_end()
+      assert(regions.empty() || regions.back().end_event_ptr);
+    }
+    internal_encode_regions(regions, zone_relation, encoders);
+    internal_encode_critical_sections(critical_sections, encoders);
+
+    if (encoders.options().break_symmetry) {
+      internal_break_symmetry(encoders);
+    }
+
+    if (0 < encoders.options().context_bound) {
+      internal_encode_contexts(zone_relation, encoders);
+    }
+
+    const ReadInstrEncoder read_encoder;
+    for (const Property& expect : expects) {
+      const smt::UnsafeTerm condition_expr(
+        expect.condition_ptr->encode(read_encoder, encoders));
+      if (expect.path_condition_ptr) {
+        encoders.solver.unsafe_add(implies(
+          expect.path_condition_ptr->encode(read_encoder, encoders),
+          condition_expr));
       } else {
-        inner_clock = then_clock;
+        encoders.solver.unsafe_add(condition_expr);
       }
     }
 
-    return inner_clock;
+    const bool has_error_conditions = !errors.empty();
+    if (has_error_conditions) {
+      encoders.solver.unsafe_add(internal_encode_errors(errors, encoders));
+    }
+
+    order_encoder.encode(zone_relation, encoders);
+    encoders.transitivity();
+
+    return has_error_conditions;
   }
 
 public:
+  /// \internal Events recorded by record() that replay() can clone
+  struct Recording {
+    Slice slice;
+    std::forward_list<Property> errors;
+    std::forward_list<Property> expects;
+
+    // see EventCloner
+    EventId begin_event_id;
+    EventId end_event_id;
+    unsigned begin_atom;
+    unsigned end_atom;
+
+    // false if there are synchronization events
+    bool is_replayable;
+  };
+
+private:
+  // recordings of the functions of threads that have been spawned with
+  // CachedRecording since the last reset
+  typedef void (*ThreadFunction)();
+  std::unordered_map<ThreadFunction, std::unique_ptr<Recording>>
+    m_thread_recording_ptrs;
+
+  // Thread whose events are clones of a recording of its function
+  struct SymmetricThread {
+    ThreadFunction f;
+    ThreadId thread_id;
+
+    // send event of the spawning thread, and last event of the thread
+    std::shared_ptr<SendEvent> spawn_event_ptr;
+    std::shared_ptr<SendEvent> end_event_ptr;
+
+    // nullptr unless the thread has been joined exactly once
+    std::shared_ptr<ReceiveEvent> join_event_ptr;
+    unsigned join_count;
+
+    // Can the threads be swapped in every execution? This is the case if
+    // the next thread is spawned right after this thread, and joined
+    // right after it unless neither of them is joined.
+    bool is_interchangeable(const SymmetricThread& next) const {
+      if (f != next.f || 1 < join_count || join_count != next.join_count ||
+          !are_adjacent(*spawn_event_ptr, *next.spawn_event_ptr,
+            end_event_ptr->event_id())) {
+        return false;
+      }
+
+      return join_count == 0 || are_adjacent(*join_event_ptr,
+        *next.join_event_ptr, join_event_ptr->event_id());
+    }
+
+    // Is there no event between x and y in their thread?
+    static bool are_adjacent(const Event& x, const Event& y,
+      EventId last_event_id) {
+
+      return x.thread_id() == y.thread_id() &&
+        x.condition_ptr() == y.condition_ptr() &&
+        last_event_id + 1 == y.event_id();
+    }
+  };
+
+  // in the order in which the threads have been spawned
+  std::vector<SymmetricThread> m_symmetric_threads;
+
+public:
+
   /// \internal Modifiable reference to the current thread
 
   /// \pre: Threads::begin_thread(const Thread&) must have been called
   static Thread& current_thread() {
-    assert(s_singleton.m_current_thread_ptr != nullptr);
-    return *s_singleton.m_current_thread_ptr;
+    assert(singleton().m_current_thread_ptr != nullptr);
+    return *singleton().m_current_thread_ptr;
   }
 
   static std::shared_ptr<Block> slice_most_outer_block_ptr(ThreadId thread_id) {
-    return s_singleton.m_slice_map[thread_id].most_outer_block_ptr();
+    return singleton().m_slice_map[thread_id].most_outer_block_ptr();
+  }
+
+  /// Innermost block that is currently being recorded in the given thread
+  static std::shared_ptr<Block> slice_current_block_ptr(ThreadId thread_id) {
+    return singleton().m_slice_map[thread_id].current_block_ptr();
+  }
+
+  /// Append all the events recorded in every thread
+  static void filter(std::forward_list<std::shared_ptr<Event>>& event_ptrs) {
+    for (SliceMap::const_reference slice_map_value : singleton().m_slice_map) {
+      slice_map_value.second.most_outer_block_ptr()->filter(event_ptrs);
+    }
+  }
+
+  /// Read events in all the recorded error and expect conditions
+  static const std::forward_list<std::shared_ptr<Event>>& property_event_ptrs() {
+    return singleton().m_property_event_ptrs;
   }
 
   static void slice_append(ThreadId thread_id, const EventPtr& event_ptr) {
-    s_singleton.m_slice_map[thread_id].append(event_ptr);
+    singleton().m_slice_map[thread_id].append(event_ptr);
   }
 
   /// Append all read events that are in the given instruction
   template<typename T>
   static void slice_append_all(ThreadId thread_id, const ReadInstr<T>& instr) {
-    s_singleton.m_slice_map[thread_id].append_all(instr);
+    singleton().m_slice_map[thread_id].append_all(instr);
   }
 
   /// Append all the given event pointers
   static void slice_append_all(ThreadId thread_id,
     const std::forward_list<std::shared_ptr<Event>>& event_ptrs) {
-    s_singleton.m_slice_map[thread_id].append_all(event_ptrs);
+    singleton().m_slice_map[thread_id].append_all(event_ptrs);
   }
 
   static void slice_begin_then(ThreadId thread_id,
     const std::shared_ptr<ReadInstr<bool>>& condition_ptr) {
-    s_singleton.m_slice_map[thread_id].begin_then(condition_ptr);
+    singleton().m_slice_map[thread_id].begin_then(condition_ptr);
   }
 
   static void slice_begin_else(ThreadId thread_id) {
-    s_singleton.m_slice_map[thread_id].begin_else();
+    singleton().m_slice_map[thread_id].begin_else();
   }
 
   static void slice_end_branch(ThreadId thread_id) {
-    s_singleton.m_slice_map[thread_id].end_branch();
+    singleton().m_slice_map[thread_id].end_branch();
   }
 
   /// Erase any previous thread recordings
   static void reset(unsigned next_event_id = 0, unsigned next_zone = 0) {
-    return s_singleton.internal_reset(next_event_id, next_zone);
+    return singleton().internal_reset(next_event_id, next_zone);
+  }
+
+  /// Identifier that changes whenever the recorded threads are erased
+
+  /// Clones of a Recording may only be replayed as long as the identifier
+  /// is the same as when the recording was made.
+  static unsigned long long recording_id() {
+    return singleton().m_recording_id;
+  }
+
+  /// Record `f()` in the current thread without appending to its slice
+
+  /// The events are recorded under an empty path condition in a separate
+  /// slice, and the error and expect conditions are kept in the recording.
+  /// Neither of them is encoded unless the recording is replayed.
+  template<typename Function>
+  static std::unique_ptr<Recording> record(Function&& f) {
+    Threads& threads = singleton();
+    Thread& thread = current_thread();
+    const ThreadId thread_id = thread.thread_id();
+
+    Slice slice(std::move(threads.m_slice_map[thread_id]));
+    threads.m_slice_map.erase(thread_id);
+
+    size_t condition_ptrs_size = 0;
+    Thread::ConditionPtrs condition_ptrs;
+    std::stack<Thread::ConditionPtr> path_condition_ptr_cache;
+    std::swap(thread.m_condition_ptrs_size, condition_ptrs_size);
+    thread.m_condition_ptrs.swap(condition_ptrs);
+    std::swap(thread.m_path_condition_ptr_cache, path_condition_ptr_cache);
+
+    std::forward_list<Property> errors;
+    std::forward_list<Property> expects;
+    std::forward_list<std::shared_ptr<Event>> property_event_ptrs;
+    threads.m_errors.swap(errors);
+    threads.m_expects.swap(expects);
+    threads.m_property_event_ptrs.swap(property_event_ptrs);
+
+    const ThreadId begin_thread_id = Thread::next_thread_id();
+    const EventId begin_event_id = Event::peek_id();
+    const unsigned begin_atom = Zone::next_atom();
+    f();
+    const EventId end_event_id = Event::peek_id();
+    const unsigned end_atom = Zone::next_atom();
+    const ThreadId end_thread_id = Thread::next_thread_id();
+
+    // threads spawned by f() are recorded again if it is executed as usual
+    for (ThreadId child_thread_id = begin_thread_id;
+         child_thread_id < end_thread_id; child_thread_id++) {
+      threads.m_slice_map.erase(child_thread_id);
+    }
+
+    std::unique_ptr<Recording> recording_ptr(new Recording{
+      std::move(threads.m_slice_map[thread_id]),
+      std::move(threads.m_errors), std::move(threads.m_expects),
+      begin_event_id, end_event_id, begin_atom, end_atom, true});
+
+    threads.m_slice_map.erase(thread_id);
+    threads.m_slice_map.emplace(thread_id, std::move(slice));
+
+    std::swap(thread.m_condition_ptrs_size, condition_ptrs_size);
+    thread.m_condition_ptrs.swap(condition_ptrs);
+    std::swap(thread.m_path_condition_ptr_cache, path_condition_ptr_cache);
+
+    threads.m_errors.swap(errors);
+    threads.m_expects.swap(expects);
+    threads.m_property_event_ptrs.swap(property_event_ptrs);
+
+    std::forward_list<std::shared_ptr<Event>> event_ptrs;
+    recording_ptr->slice.most_outer_block_ptr()->filter(event_ptrs);
+    for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+      if (event_ptr->is_sync()) {
+        recording_ptr->is_replayable = false;
+        break;
+      }
+    }
+
+    return recording_ptr;
+  }
+
+  /// Append clones of the recorded events to the cloner's thread
+
+  /// The error and expect conditions of the recording are cloned as well.
+  ///
+  /// \pre recording.is_replayable
+  /// \pre the recording is not older than recording_id()
+  static void replay(const Recording& recording, EventCloner& cloner) {
+    assert(recording.is_replayable);
+
+    internal_replay(*recording.slice.most_outer_block_ptr(), cloner);
+    for (const Property& error : recording.errors) {
+      singleton().m_errors.push_front(internal_clone(error, cloner));
+    }
+    for (const Property& expect : recording.expects) {
+      singleton().m_expects.push_front(internal_clone(expect, cloner));
+    }
+  }
+
+  /// \internal Append clones of the recording of `f()` to the current thread
+
+  /// The function is recorded by its first call since the last reset(). If
+  /// the recording is not replayable, `f()` is executed as usual instead.
+  ///
+  /// \returns has the recording been replayed?
+  static bool replay_thread(ThreadFunction f) {
+    // references to elements are stable even if f() spawns other threads
+    std::unique_ptr<Recording>& recording_ptr =
+      singleton().m_thread_recording_ptrs[f];
+
+    if (!recording_ptr) {
+      recording_ptr = record(f);
+    }
+
+    if (!recording_ptr->is_replayable) {
+      f();
+      return false;
+    }
+
+    const Recording& recording = *recording_ptr;
+    EventCloner cloner(ThisThread::thread_id(), ThisThread::path_condition_ptr(),
+      recording.begin_event_id, recording.end_event_id,
+      recording.begin_atom, recording.end_atom);
+
+    replay(recording, cloner);
+    return true;
+  }
+
+  /// \internal Remember a thread that replay_thread(ThreadFunction) has
+  /// recorded, see EncoderOptions::break_symmetry
+
+  /// \param spawn_event_ptr - event that has spawned the thread
+  static void add_symmetric_thread(ThreadFunction f, const Thread& thread,
+    const std::shared_ptr<SendEvent>& spawn_event_ptr) {
+
+    assert(nullptr != thread.m_send_event_ptr);
+    singleton().m_symmetric_threads.push_back(SymmetricThread{f,
+      thread.thread_id(), spawn_event_ptr, thread.m_send_event_ptr,
+      nullptr, 0});
+  }
+
+  /// Drop the error and expect conditions of a recording that will not be
+  /// encoded
+  static void discard() {
+    singleton().m_errors.clear();
+    singleton().m_expects.clear();
   }
 
   /// Start recording a new thread of execution
   static void begin_thread() {
-    s_singleton.m_thread_stack.push(Thread(s_singleton.m_current_thread_ptr));
-    begin_thread(&s_singleton.m_thread_stack.top());
+    singleton().m_thread_stack.push(Thread(singleton().m_current_thread_ptr));
+    begin_thread(&singleton().m_thread_stack.top());
   }
 
   /// Demarcate the start of a new child thread
-  static void begin_thread(Thread* child_thread_ptr) {
+
+  /// \returns event of the parent thread that spawns the child thread, or
+  ///          nullptr if there is no parent thread
+  static std::shared_ptr<SendEvent> begin_thread(Thread* child_thread_ptr) {
     Thread& child_thread = *child_thread_ptr;
+    std::shared_ptr<SendEvent> send_event_ptr(nullptr);
     if (child_thread.parent_thread_ptr()) {
       Thread& parent_thread = *child_thread.parent_thread_ptr();
-      const std::shared_ptr<SendEvent> send_event_ptr(new SendEvent(
+      send_event_ptr.reset(new SendEvent(
         parent_thread.thread_id(), parent_thread.path_condition_ptr()));
       slice_append(parent_thread.thread_id(), send_event_ptr);
 
@@ -342,6 +1147,7 @@ public:
       slice_append(child_thread.thread_id(), std::move(receive_event_ptr));
     }
     set_current_thread_ptr(child_thread_ptr);
+    return send_event_ptr;
   }
 
   /// Stop the recording of the current thread of execution 
@@ -354,8 +1160,8 @@ public:
     slice_append(ThisThread::thread_id(), send_event_ptr);
     set_current_thread_ptr(current_thread().parent_thread_ptr());
 
-    if (!s_singleton.m_thread_stack.empty()) {
-      s_singleton.m_thread_stack.pop();
+    if (!singleton().m_thread_stack.empty()) {
+      singleton().m_thread_stack.pop();
     }
 
     return send_event_ptr;
@@ -366,7 +1172,7 @@ public:
   /// \pre: There are no unfinished thread recordings in progress
   /// \remark The precondition is ensured by Threads::reset()
   static void begin_main_thread() {
-    assert(s_singleton.m_thread_stack.empty());
+    assert(singleton().m_thread_stack.empty());
     begin_thread();
   }
 
@@ -376,7 +1182,7 @@ public:
   ///
   /// \returns is there at least one error condition to check?
   static bool end_main_thread(Encoders& encoders) {
-    assert(s_singleton.m_thread_stack.size() == 1);
+    assert(singleton().m_thread_stack.size() == 1);
     end_thread();
     return encode(encoders);
   }
@@ -385,55 +1191,128 @@ public:
   ///
   /// \pre: when called, there are only unconditional events in the main thread
   static void begin_slice_loop() {
-    assert(s_singleton.m_thread_stack.size() == 1);
-    assert(s_singleton.m_slice_map.size() == 1);
+    assert(singleton().m_thread_stack.size() == 1);
+    assert(singleton().m_slice_map.size() == 1);
 
-    s_singleton.m_main_thread_id = ThisThread::thread_id();
-    const Slice& main_slice = s_singleton.m_slice_map.at(
-      s_singleton.m_main_thread_id);
-    s_singleton.m_main_init_event_ptrs = main_slice.current_block_body();
+    singleton().m_main_thread_id = ThisThread::thread_id();
+    const Slice& main_slice = singleton().m_slice_map.at(
+      singleton().m_main_thread_id);
+    singleton().m_main_init_event_ptrs = main_slice.current_block_body();
   }
 
   /// Symbolically encodes all sliced memory accesses between threads
 
   /// \returns is there at least one error condition to check?
   static bool encode(Encoders& encoders) {
-    ZoneRelation<Event> zone_relation;
-    const Z3OrderEncoderC0 order_encoder;
+    const bool has_error_conditions = internal_encode(singleton().m_errors,
+      singleton().m_expects, encoders);
+    discard();
+    return has_error_conditions;
+  }
 
-#ifdef __USE_MATRIX__
-    const Clock epoch_clock("epoch");
-#else
-    const Clock epoch_clock(smt::any<ClockSort>("epoch"));
-#endif
-    for (SliceMap::const_reference slice_map_value : s_singleton.m_slice_map) {
-      const std::shared_ptr<Block> most_outer_block_ptr =
-        slice_map_value.second.most_outer_block_ptr();
-      internal_encode_spo(most_outer_block_ptr, epoch_clock, zone_relation, encoders);
+  /// Check the error conditions one group of independent errors at a time
+
+  /// Two error conditions are in the same group if their \ref DependencyCone
+  /// "dependency cones" overlap. All recorded events and expect conditions
+  /// are encoded once. Then the disjunction of every group's error
+  /// conditions is checked on its own under a push() until one of them is
+  /// satisfiable.
+  ///
+  /// Only the error conditions are split. Events outside a group's cones
+  /// are still encoded because they can make the formula unsatisfiable,
+  /// e.g. if reads of other memory cannot all read from distinct writes, or
+  /// order the events in the cones through the program order.
+  ///
+  /// The encoders are reset before the recording is encoded. Afterwards,
+  /// the recording is discarded as if encode(Encoders&) had been called.
+  ///
+  /// \returns smt::sat if some group is satisfiable, smt::unsat if all
+  ///          groups are unsatisfiable (or there are none), and
+  ///          smt::unknown otherwise
+  static smt::CheckResult check_components(Encoders& encoders) {
+    typedef std::forward_list<std::shared_ptr<Event>> EventPtrs;
+
+    EventPtrs event_ptrs;
+    filter(event_ptrs);
+
+    const std::vector<Property> errors(singleton().m_errors.cbegin(),
+      singleton().m_errors.cend());
+
+    std::vector<DependencyCone> error_cones;
+    for (const Property& error : errors) {
+      EventPtrs property_event_ptrs;
+      internal_filter(error, property_event_ptrs);
+      error_cones.emplace_back(property_event_ptrs, event_ptrs);
     }
 
-    bool has_error_conditions = !s_singleton.m_error_exprs.empty();
-    if (has_error_conditions) {
-      smt::UnsafeTerm some_error_expr(smt::literal<smt::Bool>(false));
-      for (const smt::UnsafeTerm& error_expr : s_singleton.m_error_exprs) {
-        some_error_expr = some_error_expr or error_expr;
+    // union-find over the error conditions
+    std::vector<size_t> parents(errors.size());
+    for (size_t i = 0; i < errors.size(); i++) {
+      parents[i] = i;
+      for (size_t j = 0; j < i; j++) {
+        if (error_cones[i].overlaps(error_cones[j])) {
+          parents[internal_find(parents, j)] = i;
+        }
       }
-      encoders.solver.unsafe_add(some_error_expr);
+    }
 
-      s_singleton.m_error_exprs.clear();
+    std::vector<size_t> roots(errors.size());
+    for (size_t i = 0; i < errors.size(); i++) {
+      roots[i] = internal_find(parents, i);
     }
 
-    order_encoder.encode(zone_relation, encoders);
+    encoders.reset();
+    internal_encode(std::forward_list<Property>(), singleton().m_expects,
+      encoders);
 
-    return has_error_conditions;
+    // deferred axioms would otherwise be popped with the first group
+    encoders.add_deferred_axioms();
+
+    smt::CheckResult result = smt::unsat;
+    for (size_t root = 0; root < errors.size(); root++) {
+      if (roots[root] != root) {
+        continue;
+      }
+
+      std::forward_list<Property> group_errors;
+      for (size_t i = 0; i < errors.size(); i++) {
+        if (roots[i] == root) {
+          group_errors.push_front(errors[i]);
+        }
+      }
+
+      encoders.solver.push();
+      encoders.solver.unsafe_add(internal_encode_errors(group_errors,
+        encoders));
+      const smt::CheckResult group_result = encoders.check();
+      encoders.solver.pop();
+
+      if (group_result == smt::sat) {
+        result = smt::sat;
+        break;
+      }
+      if (group_result != smt::unsat) {
+        result = smt::unknown;
+      }
+    }
+
+    discard();
+    return result;
   }
 
   static void join(const std::shared_ptr<SendEvent>& send_event_ptr) {
-    std::unique_ptr<ReceiveEvent> receive_event_ptr(new ReceiveEvent(
+    const std::shared_ptr<ReceiveEvent> receive_event_ptr(new ReceiveEvent(
       ThisThread::thread_id(), send_event_ptr->zone(),
       ThisThread::path_condition_ptr()));
 
-    slice_append(ThisThread::thread_id(), std::move(receive_event_ptr));
+    for (SymmetricThread& symmetric_thread : singleton().m_symmetric_threads) {
+      if (symmetric_thread.end_event_ptr == send_event_ptr) {
+        symmetric_thread.join_event_ptr = receive_event_ptr;
+        symmetric_thread.join_count++;
+      }
+    }
+
+    slice_append(ThisThread::thread_id(), receive_event_ptr);
   }
 
   /// \internal Assert given condition in the SAT solver outside of any thread
@@ -443,6 +1322,8 @@ public:
   ///
   /// \warning Path conditions are ignored and an unsatisfiable error
   ///          condition renders any others unsatisfiable as well
+  /// \warning Literals in the condition are not narrowed, see
+  ///          EncoderOptions::narrow_values
   static void internal_error(std::unique_ptr<ReadInstr<bool>> condition_ptr, Encoders& encoders) {
     const ValueEncoder value_encoder;
     const smt::UnsafeTerm condition_expr(value_encoder.encode_eq(
@@ -451,55 +1332,42 @@ public:
     encoders.solver.unsafe_add(condition_expr);
   }
 
-  /// Assert condition with the current thread's path condition as antecedent
+  /// Assume condition with the current thread's path condition as antecedent
+
+  /// The assumption is asserted in the solver by encode(Encoders&).
   static void expect(std::unique_ptr<ReadInstr<bool>> condition_ptr, Encoders& encoders) {
     slice_append_all(ThisThread::thread_id(), *condition_ptr);
+    condition_ptr->filter(singleton().m_property_event_ptrs);
 
-    const ValueEncoder value_encoder;
-    const smt::UnsafeTerm condition_expr(value_encoder.encode_eq(
-      std::move(condition_ptr), encoders));
-
-    const std::shared_ptr<ReadInstr<bool>> path_condition_ptr(
-      ThisThread::path_condition_ptr());
-    if (path_condition_ptr) {
-      const ReadInstrEncoder read_encoder;
-      encoders.solver.unsafe_add(implies(path_condition_ptr->encode(read_encoder, encoders),
-        condition_expr));
-    } else {
-      encoders.solver.unsafe_add(condition_expr);
-    }
+    const Property expect = {std::move(condition_ptr),
+      ThisThread::path_condition_ptr()};
+    singleton().m_expects.push_front(expect);
   }
 
-  /// Assert condition in the SAT solver and record the condition's read events
+  /// Record the condition's read events and assert it in the SAT solver
 
+  /// The condition is asserted in the solver by encode(Encoders&).
+  ///
   /// \remark The logical disjunction of all given error conditions allows
   ///         multiple of them to be checked simultaneously by the SAT solver
   static void error(std::unique_ptr<ReadInstr<bool>> condition_ptr, Encoders& encoders) {
     slice_append_all(ThisThread::thread_id(), *condition_ptr);
+    condition_ptr->filter(singleton().m_property_event_ptrs);
 
-    const ValueEncoder value_encoder;
-    const smt::UnsafeTerm error_condition_expr(value_encoder.encode_eq(
-      std::move(condition_ptr), encoders));
-
-    const std::shared_ptr<ReadInstr<bool>> path_condition_ptr(
-      ThisThread::path_condition_ptr());
-    if (path_condition_ptr) {
-      const ReadInstrEncoder read_encoder;
-      s_singleton.m_error_exprs.push_front(error_condition_expr and
-        path_condition_ptr->encode(read_encoder, encoders));
-    } else {
-      s_singleton.m_error_exprs.push_front(error_condition_expr);
-    }
+    const Property error = {std::move(condition_ptr),
+      ThisThread::path_condition_ptr()};
+    singleton().m_errors.push_front(error);
   }
 };
 
 template<typename Function, typename... Args>
 Thread::Thread(Function&& f, Args&&... args) :
-  m_thread_id(s_next_thread_id++),
+  m_thread_id(next_thread_id()++),
   m_parent_thread_ptr(&Threads::current_thread()),
   m_send_event_ptr(nullptr),
   m_condition_ptrs_size(0),
-  m_condition_ptrs() {
+  m_condition_ptrs(),
+  m_atomic_depth(0) {
 
   Threads::begin_thread(this);
   f(args...);
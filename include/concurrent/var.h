@@ -16,6 +16,7 @@ namespace se {
 
 template<typename T> class LocalVar;
 template<typename T> class SharedVar;
+template<typename... Args> class Summary;
 
 template<typename T>
 std::unique_ptr<ReadInstr<T>> alloc_read_instr(const LocalVar<T>& var);
@@ -322,6 +323,8 @@ private:
   DeclVar<T> m_var;
   LocalRead<T> m_local_read;
 
+  template<typename... Args> friend class Summary;
+
 public:
   LocalVar() : m_var(false), m_local_read(internal_make_read_event<T>(
     m_var.zone(), m_var.direct_write_event_ref().event_id())) {}
@@ -419,6 +422,66 @@ class SharedVar {
 private:
   DeclVar<T> m_var;
 
+  // Read event of a read-modify-write operation whose value is copied into
+  // thread-local memory, so that it can be used without reading again
+  struct RmwRead {
+    std::shared_ptr<ReadEvent<T>> read_event_ptr;
+
+    // reads the thread-local copy
+    std::shared_ptr<ReadEvent<T>> local_read_event_ptr;
+
+    std::unique_ptr<ReadInstr<T>> value() const {
+      return std::unique_ptr<ReadInstr<T>>(new BasicReadInstr<T>(
+        local_read_event_ptr));
+    }
+  };
+
+  RmwRead rmw_read() {
+    const ThreadId thread_id = ThisThread::thread_id();
+    const std::shared_ptr<ReadEvent<T>> read_event_ptr(
+      make_read_event<T>(zone()));
+    const std::shared_ptr<DirectWriteEvent<T>> copy_event_ptr(
+      new DirectWriteEvent<T>(thread_id, /* thread-local */ Zone::bottom(),
+        std::unique_ptr<ReadInstr<T>>(new BasicReadInstr<T>(read_event_ptr)),
+        ThisThread::path_condition_ptr()));
+
+    Threads::slice_append(thread_id, read_event_ptr);
+    Threads::slice_append(thread_id, copy_event_ptr);
+
+    return RmwRead{read_event_ptr, internal_make_read_event<T>(
+      Zone::bottom(), copy_event_ptr->event_id())};
+  }
+
+  void rmw_write(const RmwRead& read, std::unique_ptr<ReadInstr<T>> instr_ptr,
+    const std::shared_ptr<ReadInstr<bool>>& condition_ptr) {
+
+    const ThreadId thread_id = ThisThread::thread_id();
+    Threads::slice_append_all<T>(thread_id, *instr_ptr);
+
+    const std::shared_ptr<DirectWriteEvent<T>> write_event_ptr(
+      new ReadModifyWriteEvent<T>(thread_id, zone(), read.read_event_ptr,
+        std::move(instr_ptr), condition_ptr));
+
+    Threads::slice_append(thread_id, write_event_ptr);
+    m_var.set_direct_write_event_ptr(write_event_ptr);
+  }
+
+  // Path condition of the current thread conjoined with the given condition
+  static std::shared_ptr<ReadInstr<bool>> rmw_condition_ptr(
+    const std::shared_ptr<ReadInstr<bool>>& condition_ptr) {
+
+    const std::shared_ptr<ReadInstr<bool>> path_condition_ptr(
+      ThisThread::path_condition_ptr());
+    if (!path_condition_ptr) {
+      return condition_ptr;
+    }
+
+    NaryReadInstr<LAND, bool>::OperandPtrs operand_ptrs = {path_condition_ptr,
+      condition_ptr};
+    return std::shared_ptr<ReadInstr<bool>>(new NaryReadInstr<LAND, bool>(
+      std::move(operand_ptrs), 2));
+  }
+
 public:
   SharedVar() : m_var(true) {}
   SharedVar(const T v) : m_var(true, v) {}
@@ -453,6 +516,46 @@ public:
     return *this;
   }
 
+  /// Atomically add `v` and return the previous value
+
+  /// Unlike `x = x + v`, the read and write events form a single
+  /// read-modify-write operation, see ReadModifyWriteEvent. The returned
+  /// instruction reads a thread-local copy of the previous value.
+  std::unique_ptr<ReadInstr<T>> fetch_add(const T v) {
+    const RmwRead read(rmw_read());
+    rmw_write(read, std::unique_ptr<ReadInstr<T>>(new BinaryReadInstr<ADD, T, T>(
+      read.value(), alloc_read_instr(v))), ThisThread::path_condition_ptr());
+    return read.value();
+  }
+
+  /// Atomically replace the value by `v` and return the previous value
+  std::unique_ptr<ReadInstr<T>> exchange(const T v) {
+    const RmwRead read(rmw_read());
+    rmw_write(read, alloc_read_instr(v), ThisThread::path_condition_ptr());
+    return read.value();
+  }
+
+  /// Atomically replace the value by `desired` if it equals `expected`
+
+  /// A failed comparison writes back the value that it has read so that
+  /// later reads can read from it.
+  ///
+  /// \returns whether the value has been replaced
+  std::unique_ptr<ReadInstr<bool>> compare_exchange(const T expected,
+    const T desired) {
+
+    const RmwRead read(rmw_read());
+    const std::shared_ptr<ReadInstr<bool>> success_ptr(
+      new BinaryReadInstr<EQL, T, T>(read.value(), alloc_read_instr(expected)));
+
+    rmw_write(read, alloc_read_instr(desired), rmw_condition_ptr(success_ptr));
+    rmw_write(read, read.value(),
+      rmw_condition_ptr(Bools::negate(success_ptr)));
+
+    return std::unique_ptr<ReadInstr<bool>>(new BinaryReadInstr<EQL, T, T>(
+      read.value(), alloc_read_instr(expected)));
+  }
+
   /// Literal index
   template<size_t N = std::extent<T>::value,
     class = typename std::enable_if<std::is_array<T>::value and 0 < N>::type>
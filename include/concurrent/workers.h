@@ -0,0 +1,92 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef LIBSE_CONCURRENT_WORKERS_H_
+#define LIBSE_CONCURRENT_WORKERS_H_
+
+#include <functional>
+
+#include "concurrent/slicer.h"
+
+namespace se {
+
+/// Explores the slices of a Slicer with a pool of worker processes
+
+/// Since the recording of threads relies on process-wide state, every worker
+/// is a forked child process with its own copy of that state. The workers
+/// share a queue of pinned branch locations, each of which describes a set
+/// of slices that is disjoint from the others.
+///
+/// Initially, the queue only contains the set of all slices. Whenever a
+/// worker is idle and the queue is empty, the next busy worker that looks
+/// for another slice splits its remaining slices: it keeps exploring the
+/// current side of its lowest unflipped branch location and enqueues the
+/// slices that take the other side, see Slicer::set_split_fn(). As soon as
+/// one worker finds a satisfiable slice, all workers are stopped.
+///
+/// If a worker crashes, all workers are stopped and the result is unknown.
+/// If shared memory or worker processes are unavailable, the slices are
+/// explored by the calling process.
+///
+/// Example:
+///
+///      int main(void) {
+///        slicer.begin_slice_loop();
+///        se::SliceWorkers workers(slicer, 32);
+///        return smt::sat == workers.run([]() -> smt::CheckResult {
+///          se::Thread::encoders().reset();
+///          ...
+///          if (!slicer.owns_slice() || !se::Thread::encode()) {
+///            return smt::unsat;
+///          }
+///          return se::Thread::encoders().check();
+///        }) ? 1 : 0;
+///      }
+class SliceWorkers {
+public:
+  /// Records, encodes and checks the current slice
+
+  /// \returns smt::unsat if the slice is discarded or has no error condition
+  typedef std::function<smt::CheckResult()> SliceFn;
+
+private:
+  struct Queue;
+
+  Slicer& m_slicer;
+  const unsigned m_worker_count;
+
+  // shared memory of all workers unless m_is_shared is false
+  Queue* m_queue_ptr;
+  bool m_is_shared;
+
+  // \internal runs inside a forked child process
+  void work(const SliceFn& slice_fn);
+
+public:
+  /// \pre 0 < worker_count
+  SliceWorkers(Slicer& slicer, unsigned worker_count);
+  SliceWorkers(const SliceWorkers&) = delete;
+  ~SliceWorkers();
+
+  unsigned worker_count() const {
+    return m_worker_count;
+  }
+
+  /// Number of recorded slices in all workers, including discarded ones
+  unsigned long long slice_count() const;
+
+  /// Explore all slices in parallel until one of them is satisfiable
+
+  /// \pre Slicer::begin_slice_loop() has been called
+  ///
+  /// \returns smt::sat if there is a satisfiable slice, smt::unsat if all
+  ///          slices are unsatisfiable, and smt::unknown if some slice is
+  ///          neither or a worker has failed before a satisfiable slice
+  ///          was found
+  smt::CheckResult run(const SliceFn& slice_fn);
+};
+
+}
+
+#endif
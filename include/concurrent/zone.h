@@ -16,7 +16,6 @@ namespace se {
 /// An element in an atomistic lattice
 class Zone {
 public:
-  static unsigned s_next_atom;
   static Zone s_bottom_element;
 
   const std::set<unsigned> m_atoms;
@@ -37,10 +36,13 @@ public:
   Zone(Zone&& other) : m_atoms(std::move(other.m_atoms)) {}
   Zone(const Zone& other) : m_atoms(other.m_atoms) {}
 
+  /// \internal Counter of the current Session that unique_atom() uses
+  static unsigned& next_atom();
+
   /// \internal Reset the counter that make() uses
-  static void reset(unsigned atom = 0) { s_next_atom = atom; }
+  static void reset(unsigned atom = 0) { next_atom() = atom; }
 
-  static Zone unique_atom() { return Zone(s_next_atom++); }
+  static Zone unique_atom() { return Zone(next_atom()++); }
   static const Zone& bottom() { return s_bottom_element; }
 
   bool operator==(const Zone& other) const { return m_atoms == other.m_atoms; }
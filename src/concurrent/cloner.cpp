@@ -0,0 +1,118 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "concurrent/cloner.h"
+
+namespace se {
+
+EventCloner::EventCloner(ThreadId thread_id, const ConditionPtr& condition_ptr,
+  EventId begin_event_id, EventId end_event_id,
+  unsigned begin_atom, unsigned end_atom) :
+  m_thread_id(thread_id),
+  m_condition_ptr(condition_ptr),
+  m_begin_event_id(begin_event_id),
+  m_end_event_id(end_event_id),
+  m_begin_atom(begin_atom),
+  m_end_atom(end_atom),
+  m_event_ptrs(),
+  m_event_ids(),
+  m_atoms(),
+  m_instr_ptrs(),
+  m_condition_ptrs() {
+
+  assert(m_begin_event_id <= m_end_event_id);
+  assert(m_begin_atom <= m_end_atom);
+}
+
+void EventCloner::bind(const std::shared_ptr<Event>& event_ptr,
+  const std::shared_ptr<Event>& clone_ptr) {
+
+  assert(nullptr != event_ptr);
+  assert(nullptr != clone_ptr);
+
+  m_event_ptrs[event_ptr.get()] = clone_ptr;
+}
+
+std::shared_ptr<Event> EventCloner::event_ptr(
+  const std::shared_ptr<Event>& event_ptr) {
+
+  const auto event_ptr_iter = m_event_ptrs.find(event_ptr.get());
+  if (event_ptr_iter != m_event_ptrs.cend()) {
+    return event_ptr_iter->second;
+  }
+
+  if (!is_recorded(event_ptr->event_id())) {
+    return event_ptr;
+  }
+
+  const std::shared_ptr<Event> clone_ptr(event_ptr->clone(*this));
+  assert(nullptr != clone_ptr);
+
+  if (event_ptr->is_write()) {
+    m_event_ids[event_ptr->event_id()] = clone_ptr->event_id();
+  }
+  m_event_ptrs[event_ptr.get()] = clone_ptr;
+  return clone_ptr;
+}
+
+Zone EventCloner::zone(const Zone& zone) {
+  if (zone.is_bottom()) {
+    return zone;
+  }
+
+  std::set<unsigned> atoms;
+  for (unsigned atom : zone.m_atoms) {
+    if (atom < m_begin_atom || m_end_atom <= atom) {
+      atoms.insert(atom);
+      continue;
+    }
+
+    auto atom_iter = m_atoms.find(atom);
+    if (atom_iter == m_atoms.end()) {
+      atom_iter = m_atoms.emplace(atom, Zone::next_atom()++).first;
+    }
+    atoms.insert(atom_iter->second);
+  }
+  return Zone(std::move(atoms));
+}
+
+EventCloner::ConditionPtr EventCloner::instr_ptr(const ConditionPtr& instr_ptr) {
+  if (!instr_ptr) {
+    return nullptr;
+  }
+
+  const auto instr_ptr_iter = m_instr_ptrs.find(instr_ptr.get());
+  if (instr_ptr_iter != m_instr_ptrs.cend()) {
+    return instr_ptr_iter->second;
+  }
+
+  const ConditionPtr clone_ptr(instr_ptr->clone(*this));
+  m_instr_ptrs[instr_ptr.get()] = clone_ptr;
+  return clone_ptr;
+}
+
+EventCloner::ConditionPtr EventCloner::condition_ptr(
+  const ConditionPtr& condition_ptr) {
+
+  if (!condition_ptr) {
+    return m_condition_ptr;
+  }
+
+  const auto condition_ptr_iter = m_condition_ptrs.find(condition_ptr.get());
+  if (condition_ptr_iter != m_condition_ptrs.cend()) {
+    return condition_ptr_iter->second;
+  }
+
+  ConditionPtr clone_ptr(instr_ptr(condition_ptr));
+  if (m_condition_ptr) {
+    NaryReadInstr<LAND, bool>::OperandPtrs operand_ptrs = {m_condition_ptr,
+      clone_ptr};
+    clone_ptr.reset(new NaryReadInstr<LAND, bool>(std::move(operand_ptrs), 2));
+  }
+
+  m_condition_ptrs[condition_ptr.get()] = clone_ptr;
+  return clone_ptr;
+}
+
+}
@@ -0,0 +1,254 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <forward_list>
+
+#include "concurrent/cubes.h"
+#include "concurrent/thread.h"
+
+namespace se {
+
+// \internal result of a child process as sent through a pipe
+static char encode_result(smt::CheckResult result) {
+  switch (result) {
+  case smt::sat:
+    return 's';
+  case smt::unsat:
+    return 'u';
+  default:
+    return '?';
+  }
+}
+
+static smt::CheckResult decode_result(char result) {
+  switch (result) {
+  case 's':
+    return smt::sat;
+  case 'u':
+    return smt::unsat;
+  default:
+    return smt::unknown;
+  }
+}
+
+CubeSplitter::CubeSplitter(unsigned worker_count,
+  unsigned long long max_cube_count) :
+  m_worker_count(worker_count),
+  m_max_cube_count(max_cube_count),
+  m_cube_count(0) {
+
+  assert(0 < m_worker_count);
+  assert(0 < m_max_cube_count);
+}
+
+smt::UnsafeTerms CubeSplitter::split(Encoders& encoders) const {
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  std::vector<const Event*> write_events;
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (event_ptr->is_write() && !event_ptr->zone().is_bottom()) {
+      write_events.push_back(event_ptr.get());
+    }
+  }
+
+  // shared read events with more than one candidate write event
+  typedef std::pair<const Event*, std::vector<const Event*>> Candidates;
+  std::vector<Candidates> reads;
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    const Event& read_event = *event_ptr;
+    if (!read_event.is_read() || read_event.zone().is_bottom()) {
+      continue;
+    }
+
+    Candidates read(&read_event, std::vector<const Event*>());
+    for (const Event* write_event : write_events) {
+      if (!write_event->zone().meet(read_event.zone()).is_bottom()) {
+        read.second.push_back(write_event);
+      }
+    }
+
+    if (1 < read.second.size()) {
+      reads.push_back(std::move(read));
+    }
+  }
+
+  std::stable_sort(reads.begin(), reads.end(),
+    [](const Candidates& x, const Candidates& y) {
+      return x.second.size() > y.second.size();
+    });
+
+  smt::UnsafeTerms cubes(1, smt::literal<smt::Bool>(true));
+  for (const Candidates& read : reads) {
+    // one more choice if the read event is not enabled
+    const unsigned long long choice_count = read.second.size() + 1;
+    if (m_max_cube_count / choice_count < cubes.size()) {
+      break;
+    }
+
+    smt::UnsafeTerms next_cubes;
+    next_cubes.reserve(cubes.size() * choice_count);
+
+    smt::UnsafeTerm no_rf(smt::literal<smt::Bool>(true));
+    for (const Event* write_event : read.second) {
+      const smt::UnsafeTerm rf(encoders.rf(*write_event, *read.first));
+      no_rf = no_rf and not rf;
+      for (const smt::UnsafeTerm& cube : cubes) {
+        next_cubes.push_back(cube and rf);
+      }
+    }
+
+    for (const smt::UnsafeTerm& cube : cubes) {
+      next_cubes.push_back(cube and no_rf);
+    }
+
+    cubes = std::move(next_cubes);
+  }
+
+  return cubes;
+}
+
+smt::CheckResult CubeSplitter::work(unsigned worker,
+  const smt::UnsafeTerms& cubes, Encoders& encoders) const {
+
+  // deferred axioms would otherwise be popped with the first cube
+  encoders.add_deferred_axioms();
+
+  smt::CheckResult result = smt::unsat;
+  for (size_t index = worker; index < cubes.size(); index += m_worker_count) {
+    encoders.solver.push();
+    encoders.solver.unsafe_add(cubes[index]);
+    const smt::CheckResult cube_result = encoders.solver.check();
+    encoders.solver.pop();
+
+    if (cube_result == smt::sat) {
+      return smt::sat;
+    }
+
+    if (cube_result != smt::unsat) {
+      result = smt::unknown;
+    }
+  }
+  return result;
+}
+
+smt::CheckResult CubeSplitter::check(Encoders& encoders) {
+  const smt::UnsafeTerms cubes(split(encoders));
+  m_cube_count = cubes.size();
+
+  if (m_cube_count == 1 || m_worker_count == 1) {
+    return m_cube_count == 1 ? encoders.check() : work(0, cubes, encoders);
+  }
+
+  const unsigned worker_count = std::min<unsigned long long>(m_worker_count,
+    m_cube_count);
+  std::vector<pid_t> pids(worker_count, -1);
+  std::vector<int> fds(worker_count, -1);
+
+  // a worker that cannot be started leaves its cubes unchecked
+  bool is_complete = true;
+  for (unsigned worker = 0; worker < worker_count; worker++) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+      is_complete = false;
+      continue;
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+      close(pipe_fds[0]);
+
+      const char c = encode_result(work(worker, cubes, encoders));
+      if (write(pipe_fds[1], &c, 1) != 1) {
+        _exit(1);
+      }
+      _exit(0);
+    }
+
+    close(pipe_fds[1]);
+    if (pid < 0) {
+      close(pipe_fds[0]);
+      is_complete = false;
+      continue;
+    }
+
+    pids[worker] = pid;
+    fds[worker] = pipe_fds[0];
+  }
+
+  smt::CheckResult result = smt::unsat;
+  std::vector<struct pollfd> poll_fds;
+  std::vector<unsigned> poll_workers;
+  for (;;) {
+    poll_fds.clear();
+    poll_workers.clear();
+    for (unsigned worker = 0; worker < worker_count; worker++) {
+      if (fds[worker] != -1) {
+        const struct pollfd poll_fd = {fds[worker], POLLIN, 0};
+        poll_fds.push_back(poll_fd);
+        poll_workers.push_back(worker);
+      }
+    }
+
+    if (poll_fds.empty()) {
+      break;
+    }
+
+    if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+      is_complete = false;
+      break;
+    }
+
+    for (size_t k = 0; k < poll_fds.size() && result != smt::sat; k++) {
+      if (poll_fds[k].revents == 0) {
+        continue;
+      }
+
+      const unsigned worker = poll_workers[k];
+      char c = '?';
+      if (read(fds[worker], &c, 1) != 1) {
+        c = '?';
+      }
+
+      const smt::CheckResult worker_result = decode_result(c);
+      if (worker_result == smt::sat) {
+        result = smt::sat;
+      } else if (worker_result != smt::unsat) {
+        is_complete = false;
+      }
+
+      close(fds[worker]);
+      fds[worker] = -1;
+    }
+
+    if (result == smt::sat) {
+      break;
+    }
+  }
+
+  for (unsigned worker = 0; worker < worker_count; worker++) {
+    if (fds[worker] != -1) {
+      close(fds[worker]);
+    }
+
+    if (pids[worker] != -1) {
+      kill(pids[worker], SIGKILL);
+      waitpid(pids[worker], nullptr, 0);
+    }
+  }
+
+  if (result != smt::sat && !is_complete) {
+    return smt::unknown;
+  }
+  return result;
+}
+
+}
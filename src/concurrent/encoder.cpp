@@ -2,16 +2,226 @@
 // Use of this source code is governed by a BSD-style
 // license that can be found in the LICENSE file.
 
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
 #include "concurrent/encoder_c0.h"
 
 namespace se {
 
+EncoderOptions::EncoderOptions() :
+  backend(SolverBackend::Z3),
+#ifdef __USE_BV__
+  theory(Theory::BV),
+#else
+  theory(Theory::INT),
+#endif
+  happens_before(HappensBefore::CLOCKS),
+  read_from(ReadFrom::IDENTIFIERS),
+  distinctness(Distinctness::DISTINCT),
+  split_axioms(false),
+  narrow_clocks(false),
+  narrow_values(false),
+  join_clocks(true),
+  refine_axioms(false),
+  break_symmetry(true),
+  context_bound(0) {
+
+  const char* const solver_name = std::getenv("LIBSE_SOLVER");
+  if (solver_name != nullptr) {
+    if (std::strcmp(solver_name, "msat") == 0) {
+      backend = SolverBackend::MSAT;
+    } else if (std::strcmp(solver_name, "cvc4") == 0) {
+      backend = SolverBackend::CVC4;
+    } else {
+      backend = SolverBackend::Z3;
+    }
+  }
+
+  const char* const theory_name = std::getenv("LIBSE_THEORY");
+  if (theory_name != nullptr) {
+    theory = std::strcmp(theory_name, "bv") == 0 ? Theory::BV : Theory::INT;
+  }
+
+  const char* const order_name = std::getenv("LIBSE_ORDER");
+  if (order_name != nullptr && std::strcmp(order_name, "matrix") == 0) {
+    happens_before = HappensBefore::MATRIX;
+  }
+
+  const char* const rf_name = std::getenv("LIBSE_RF");
+  if (rf_name != nullptr && std::strcmp(rf_name, "selectors") == 0) {
+    read_from = ReadFrom::SELECTORS;
+  }
+
+  const char* const distinct_name = std::getenv("LIBSE_DISTINCT");
+  if (distinct_name != nullptr) {
+    if (std::strcmp(distinct_name, "pairwise") == 0) {
+      distinctness = Distinctness::PAIRWISE;
+    } else if (std::strcmp(distinct_name, "injection") == 0) {
+      distinctness = Distinctness::INJECTION;
+    } else if (std::strcmp(distinct_name, "lazy") == 0) {
+      distinctness = Distinctness::LAZY;
+    } else {
+      distinctness = Distinctness::DISTINCT;
+    }
+  }
+
+  const char* const join_clocks_name = std::getenv("LIBSE_JOIN_CLOCKS");
+  if (join_clocks_name != nullptr && std::strcmp(join_clocks_name, "off") == 0) {
+    join_clocks = false;
+  }
+
+  const char* const refine_name = std::getenv("LIBSE_REFINE");
+  if (refine_name != nullptr && std::strcmp(refine_name, "on") == 0) {
+    refine_axioms = true;
+  }
+
+  const char* const symmetry_name = std::getenv("LIBSE_SYMMETRY");
+  if (symmetry_name != nullptr && std::strcmp(symmetry_name, "off") == 0) {
+    break_symmetry = false;
+  }
+
+  const char* const context_bound_name = std::getenv("LIBSE_CONTEXT_BOUND");
+  if (context_bound_name != nullptr) {
+    context_bound = std::strtoul(context_bound_name, nullptr, 10);
+  }
+}
+
+constexpr unsigned HappensBeforeMatrix::s_epoch;
+
+HappensBeforeMatrix::HappensBeforeMatrix(const std::string& prefix)
+: m_prefix(prefix),
+  m_node_map(),
+  m_adjacency(1),
+  m_pair_count(0),
+  m_triangle_count(0) {}
+
+unsigned HappensBeforeMatrix::node(const std::string& name) {
+  if (name == "epoch") {
+    return s_epoch;
+  }
+
+  const auto node_iter = m_node_map.find(name);
+  if (node_iter != m_node_map.cend()) {
+    return node_iter->second;
+  }
+
+  const unsigned node = m_adjacency.size();
+  m_adjacency.emplace_back();
+  m_node_map[name] = node;
+  return node;
+}
+
+smt::UnsafeTerm HappensBeforeMatrix::variable(unsigned x, unsigned y) const {
+  assert(x < y);
+  return smt::any<smt::Bool>(m_prefix + std::to_string(x) + "_" +
+    std::to_string(y));
+}
+
+smt::UnsafeTerm HappensBeforeMatrix::happens_before(unsigned x, unsigned y) {
+  assert(x < m_adjacency.size());
+  assert(y < m_adjacency.size());
+
+  if (x == y || y == s_epoch) {
+    return smt::literal<smt::Bool>(false);
+  }
+  if (x == s_epoch) {
+    return smt::literal<smt::Bool>(true);
+  }
+
+  if (m_adjacency[x].insert(y).second) {
+    m_adjacency[y].insert(x);
+    m_pair_count++;
+  }
+
+  if (x < y) {
+    return variable(x, y);
+  }
+  return !variable(y, x);
+}
+
+unsigned long long HappensBeforeMatrix::transitivity(smt::Solver& solver) {
+  // the epoch has no pairs, so it is eliminated right away
+  std::vector<std::unordered_set<unsigned>> graph(m_adjacency);
+  std::vector<bool> is_eliminated(graph.size(), false);
+
+  unsigned long long triangle_count = 0;
+  for (size_t k = 0; k < graph.size(); k++) {
+    // min-degree heuristic keeps the number of fill pairs small
+    unsigned v = 0;
+    size_t min_degree = std::numeric_limits<size_t>::max();
+    for (unsigned u = 0; u < graph.size(); u++) {
+      if (!is_eliminated[u] && graph[u].size() < min_degree) {
+        v = u;
+        min_degree = graph[u].size();
+      }
+    }
+    is_eliminated[v] = true;
+
+    // the remaining neighbours of v form a clique of the chordal graph
+    const std::vector<unsigned> neighbours(graph[v].cbegin(), graph[v].cend());
+    for (size_t i = 0; i < neighbours.size(); i++) {
+      const unsigned u = neighbours[i];
+      for (size_t j = i + 1; j < neighbours.size(); j++) {
+        const unsigned w = neighbours[j];
+        if (graph[u].insert(w).second) {
+          graph[w].insert(u);
+        }
+
+        // neither v < u < w < v nor v < w < u < v
+        solver.unsafe_add(!(happens_before(v, u) && happens_before(u, w) &&
+          happens_before(w, v)));
+        solver.unsafe_add(!(happens_before(v, w) && happens_before(w, u) &&
+          happens_before(u, v)));
+        triangle_count++;
+      }
+    }
+
+    for (const unsigned u : neighbours) {
+      graph[u].erase(v);
+    }
+    graph[v].clear();
+  }
+  m_triangle_count += triangle_count;
+  return triangle_count;
+}
+
+void HappensBeforeMatrix::reset() {
+  m_node_map.clear();
+  m_adjacency.assign(1, std::unordered_set<unsigned>());
+  m_pair_count = 0;
+  m_triangle_count = 0;
+}
+
+smt::Solver* Encoders::make_solver(const EncoderOptions& options) {
+  // narrowed clocks are bit vectors even if the values are integers, which
+  // no single quantifier-free logic supports, so let the solver decide
+  if (options.narrow_clocks && options.theory == Theory::INT) {
+    switch (options.backend) {
+    case SolverBackend::MSAT:
+      return new smt::MsatSolver();
+    case SolverBackend::CVC4:
+      return new smt::CVC4Solver();
+    default:
+      return new smt::Z3Solver();
+    }
+  }
+
+  const smt::Logic logic = options.theory == Theory::BV ?
+    smt::QF_AUFBV_LOGIC : smt::QF_AUFLIA_LOGIC;
+
+  switch (options.backend) {
+  case SolverBackend::MSAT:
+    return new smt::MsatSolver(logic);
+  case SolverBackend::CVC4:
+    return new smt::CVC4Solver(logic);
+  default:
+    return new smt::Z3Solver(logic);
+  }
+}
+
 smt::UnsafeTerm SyncEvent::VALUE_ENCODER_FN_DEF
 smt::UnsafeTerm SyncEvent::CONSTANT_ENCODER_FN_DEF
 
-#ifdef __USE_MATRIX__
-const std::string Clock::s_happens_before_prefix = "happens_before_";
-const std::string Clock::s_simultaneous_prefix = "simultaneous_";
-#endif
-
 }
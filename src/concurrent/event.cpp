@@ -2,10 +2,12 @@
 // Use of this source code is governed by a BSD-style
 // license that can be found in the LICENSE file.
 
-#include "concurrent/event.h"
+#include "concurrent/session.h"
 
 namespace se {
 
-unsigned Event::s_next_id = 0;
+unsigned& Event::next_id() {
+  return Session::current().m_next_event_id;
+}
 
 }
@@ -0,0 +1,85 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include <deque>
+#include <future>
+#include <memory>
+
+#include "concurrent/pipeline.h"
+
+namespace se {
+
+SlicePipeline::SlicePipeline(Slicer& slicer, unsigned lookahead) :
+  m_slicer(slicer),
+  m_lookahead(lookahead),
+  m_slice_count(0),
+  m_sat_slice(0) {
+
+  assert(0 < m_lookahead);
+}
+
+smt::CheckResult SlicePipeline::run(const RecordFn& record_fn) {
+  // slice whose encoding is being checked on another thread
+  struct Stage {
+    unsigned long long slice;
+    std::unique_ptr<Session> session_ptr;
+    std::future<smt::CheckResult> result;
+  };
+
+  m_slice_count = 0;
+  m_sat_slice = 0;
+
+  smt::CheckResult result = smt::unsat;
+  std::deque<Stage> stages;
+  bool has_next_slice = true;
+  while (has_next_slice || !stages.empty()) {
+    if (has_next_slice && stages.size() <= m_lookahead) {
+      Stage stage;
+      stage.slice = ++m_slice_count;
+      stage.session_ptr.reset(new Session());
+
+      Session& session = *stage.session_ptr;
+      {
+        Session::Scope scope(session);
+        const bool has_error_conditions = record_fn(session.encoders());
+
+        // the slicer inspects the recording of the current session
+        has_next_slice = m_slicer.next_slice();
+
+        if (!has_error_conditions) {
+          continue;
+        }
+      }
+
+      stage.result = std::async(std::launch::async, [&session]() {
+        return session.encoders().check();
+      });
+      stages.push_back(std::move(stage));
+
+      // keep recording until the lookahead is exhausted
+      if (stages.size() <= m_lookahead) {
+        continue;
+      }
+    }
+
+    Stage& stage = stages.front();
+    const smt::CheckResult stage_result = stage.result.get();
+    if (smt::sat == stage_result) {
+      m_sat_slice = stage.slice;
+      result = smt::sat;
+
+      // the destructors of the futures wait for the remaining checks
+      break;
+    }
+
+    if (smt::unknown == stage_result) {
+      result = smt::unknown;
+    }
+    stages.pop_front();
+  }
+
+  return result;
+}
+
+}
@@ -0,0 +1,149 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "concurrent/portfolio.h"
+#include "concurrent/thread.h"
+
+namespace se {
+
+constexpr size_t Portfolio::NO_WINNER;
+
+// \internal result of a child process as sent through a pipe
+static char encode_result(smt::CheckResult result) {
+  switch (result) {
+  case smt::sat:
+    return 's';
+  case smt::unsat:
+    return 'u';
+  default:
+    return '?';
+  }
+}
+
+static smt::CheckResult decode_result(char result) {
+  switch (result) {
+  case 's':
+    return smt::sat;
+  case 'u':
+    return smt::unsat;
+  default:
+    return smt::unknown;
+  }
+}
+
+Portfolio::Portfolio(const std::vector<PortfolioConfig>& configs) :
+  m_configs(configs),
+  m_win_counts(configs.size(), 0),
+  m_winner(NO_WINNER) {
+
+  assert(!m_configs.empty());
+}
+
+smt::CheckResult Portfolio::check() {
+  const size_t config_count = m_configs.size();
+  std::vector<pid_t> pids(config_count, -1);
+  std::vector<int> fds(config_count, -1);
+
+  for (size_t index = 0; index < config_count; index++) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+      continue;
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+      close(pipe_fds[0]);
+
+      Encoders encoders(m_configs[index].options);
+      smt::CheckResult result = smt::unsat;
+      if (Threads::encode(encoders)) {
+        result = encoders.check();
+      }
+
+      const char c = encode_result(result);
+      if (write(pipe_fds[1], &c, 1) != 1) {
+        _exit(1);
+      }
+      _exit(0);
+    }
+
+    close(pipe_fds[1]);
+    if (pid < 0) {
+      close(pipe_fds[0]);
+      continue;
+    }
+
+    pids[index] = pid;
+    fds[index] = pipe_fds[0];
+  }
+
+  // the children have their own copy of the recording
+  Threads::discard();
+
+  smt::CheckResult result = smt::unknown;
+  m_winner = NO_WINNER;
+
+  std::vector<struct pollfd> poll_fds;
+  std::vector<size_t> poll_indexes;
+  for (;;) {
+    poll_fds.clear();
+    poll_indexes.clear();
+    for (size_t index = 0; index < config_count; index++) {
+      if (fds[index] != -1) {
+        const struct pollfd poll_fd = {fds[index], POLLIN, 0};
+        poll_fds.push_back(poll_fd);
+        poll_indexes.push_back(index);
+      }
+    }
+
+    if (poll_fds.empty() || poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+      break;
+    }
+
+    for (size_t k = 0; k < poll_fds.size() && m_winner == NO_WINNER; k++) {
+      if (poll_fds[k].revents == 0) {
+        continue;
+      }
+
+      const size_t index = poll_indexes[k];
+      char c = '?';
+      if (read(fds[index], &c, 1) == 1 && decode_result(c) != smt::unknown) {
+        result = decode_result(c);
+        m_winner = index;
+      }
+
+      close(fds[index]);
+      fds[index] = -1;
+    }
+
+    if (m_winner != NO_WINNER) {
+      break;
+    }
+  }
+
+  for (size_t index = 0; index < config_count; index++) {
+    if (fds[index] != -1) {
+      close(fds[index]);
+    }
+
+    if (pids[index] != -1) {
+      kill(pids[index], SIGKILL);
+      waitpid(pids[index], nullptr, 0);
+    }
+  }
+
+  if (m_winner != NO_WINNER) {
+    m_win_counts[m_winner]++;
+  }
+
+  return result;
+}
+
+}
@@ -0,0 +1,322 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include <algorithm>
+
+#include "concurrent/range.h"
+
+namespace se {
+
+constexpr RangeAnalysis::Node RangeAnalysis::NONE;
+constexpr unsigned RangeAnalysis::s_widen_round;
+
+Range Range::join(const Range& other) const {
+  if (m_is_top || other.is_empty()) {
+    return *this;
+  }
+  if (other.m_is_top || is_empty()) {
+    return other;
+  }
+  return Range::interval(std::min(m_lo, other.m_lo),
+    std::max(m_hi, other.m_hi));
+}
+
+// Is x + y within the range of long long?
+static bool can_add(long long x, long long y) {
+  if (0 < y) {
+    return x <= std::numeric_limits<long long>::max() - y;
+  }
+  return std::numeric_limits<long long>::min() - y <= x;
+}
+
+Range Range::add(const Range& other) const {
+  if (m_is_top || other.m_is_top) {
+    return Range::top();
+  }
+  if (is_empty() || other.is_empty()) {
+    return Range();
+  }
+  if (!can_add(m_lo, other.m_lo) || !can_add(m_hi, other.m_hi)) {
+    return Range::top();
+  }
+  return Range::interval(m_lo + other.m_lo, m_hi + other.m_hi);
+}
+
+Range Range::neg() const {
+  if (m_is_top || is_empty()) {
+    return *this;
+  }
+  if (m_lo == std::numeric_limits<long long>::min()) {
+    return Range::top();
+  }
+  return Range::interval(-m_hi, -m_lo);
+}
+
+Range Range::sub(const Range& other) const {
+  return add(other.neg());
+}
+
+unsigned Range::bit_width(bool is_signed) const {
+  assert(!m_is_top);
+
+  if (is_empty()) {
+    return 1;
+  }
+
+  // negative values wrap around to the largest unsigned values
+  if (!is_signed && m_lo < 0) {
+    return 64;
+  }
+
+  unsigned width = 1;
+  if (is_signed) {
+    while (width < 64 && (m_lo < -(1LL << (width - 1)) ||
+        (1LL << (width - 1)) - 1 < m_hi)) {
+      width++;
+    }
+  } else {
+    while (width < 64 && (m_hi >> width) != 0) {
+      width++;
+    }
+  }
+  return width;
+}
+
+RangeAnalysis::RangeAnalysis()
+: m_nodes(),
+  m_flows(),
+  m_node_map(),
+  m_reads(),
+  m_writes(),
+  m_value_widths(),
+  m_index_widths() {}
+
+RangeAnalysis::Node RangeAnalysis::find(Node node) {
+  while (m_nodes[node].parent != node) {
+    // path halving
+    m_nodes[node].parent = m_nodes[m_nodes[node].parent].parent;
+    node = m_nodes[node].parent;
+  }
+  return node;
+}
+
+void RangeAnalysis::unite(Node x, Node y) {
+  x = find(x);
+  y = find(y);
+  if (x != y) {
+    m_nodes[y].parent = x;
+  }
+}
+
+void RangeAnalysis::flow(Transfer transfer, Node target, Node lhs, Node rhs) {
+  const Flow flow = {transfer, target, lhs, rhs};
+  m_flows.push_back(flow);
+}
+
+RangeAnalysis::Node RangeAnalysis::make_node(bool is_signed, unsigned bv_size) {
+  const Node node = m_nodes.size();
+  const NodeInfo info = {node, Range(), is_signed, bv_size, NONE, false};
+  m_nodes.push_back(info);
+  return node;
+}
+
+RangeAnalysis::Node RangeAnalysis::key_node(const void* key, bool is_signed,
+  unsigned bv_size) {
+
+  const auto node_iter = m_node_map.find(key);
+  if (node_iter != m_node_map.cend()) {
+    return node_iter->second;
+  }
+
+  const Node node = make_node(is_signed, bv_size);
+  m_node_map[key] = node;
+  return node;
+}
+
+RangeAnalysis::Node RangeAnalysis::key_array_node(const void* key,
+  bool is_signed, unsigned bv_size) {
+
+  const auto node_iter = m_node_map.find(key);
+  if (node_iter != m_node_map.cend()) {
+    return node_iter->second;
+  }
+
+  const Node node = make_node(is_signed, bv_size);
+  const Node index = make_node(std::is_signed<size_t>::value,
+    8 * sizeof(size_t));
+
+  m_nodes[node].index = index;
+  m_nodes[node].is_array = true;
+  m_nodes[index].is_array = true;
+  m_node_map[key] = node;
+  return node;
+}
+
+void RangeAnalysis::join_range(Node node, const Range& range) {
+  m_nodes[node].range = m_nodes[node].range.join(range);
+}
+
+void RangeAnalysis::reads_from(Node target, Node source) {
+  unite(target, source);
+  flow(Transfer::COPY, target, source);
+
+  const Node target_index = m_nodes[target].index;
+  const Node source_index = m_nodes[source].index;
+  if (target_index != NONE && source_index != NONE) {
+    unite(target_index, source_index);
+    flow(Transfer::COPY, target_index, source_index);
+  } else if (target_index != NONE || source_index != NONE) {
+    // an array element aliases scalar memory
+    join_range(target, Range::top());
+  }
+}
+
+void RangeAnalysis::add(const Event& event) {
+  event.range(*this);
+  add_condition(event.condition_ptr());
+}
+
+void RangeAnalysis::solve() {
+  // thread-local write events are uniquely identified by their identifier
+  std::unordered_map<EventId, Node> local_write_map;
+  for (const std::pair<const Event*, Node>& write : m_writes) {
+    if (write.first->zone().is_bottom()) {
+      local_write_map[write.first->event_id()] = write.second;
+    }
+  }
+
+  for (const std::pair<const Event*, Node>& read : m_reads) {
+    const Event& read_event = *read.first;
+    bool has_write = false;
+    if (read_event.zone().is_bottom()) {
+      const auto write_iter = local_write_map.find(read_event.event_id());
+      if (write_iter != local_write_map.cend()) {
+        reads_from(read.second, write_iter->second);
+        has_write = true;
+      }
+    } else {
+      for (const std::pair<const Event*, Node>& write : m_writes) {
+        if (!write.first->zone().meet(read_event.zone()).is_bottom()) {
+          reads_from(read.second, write.second);
+          has_write = true;
+        }
+      }
+    }
+
+    // nondeterministic value such as any<T>()
+    if (!has_write) {
+      join_range(read.second, Range::top());
+    }
+  }
+
+  fixpoint();
+  export_widths();
+}
+
+void RangeAnalysis::fixpoint() {
+  bool is_fixpoint = false;
+  for (unsigned round = 0; !is_fixpoint; round++) {
+    is_fixpoint = true;
+    for (const Flow& flow : m_flows) {
+      const Range& lhs = m_nodes[flow.lhs].range;
+      Range range;
+      switch (flow.transfer) {
+      case Transfer::COPY:
+        range = lhs;
+        break;
+      case Transfer::ADD:
+        range = lhs.add(m_nodes[flow.rhs].range);
+        break;
+      case Transfer::SUB:
+        range = lhs.sub(m_nodes[flow.rhs].range);
+        break;
+      case Transfer::NEG:
+        range = lhs.neg();
+        break;
+      }
+
+      NodeInfo& target = m_nodes[flow.target];
+      Range join = target.range.join(range);
+
+      // values that wrap around are treated as unknown, i.e. values that
+      // are too wide for the target, or negative values of an unsigned one
+      if (!join.is_top() && !join.is_empty() &&
+          ((!target.is_signed && join.lo() < 0) ||
+           target.bv_size < join.bit_width(target.is_signed))) {
+        join = Range::top();
+      }
+
+      if (join != target.range) {
+        // widen intervals that keep growing
+        target.range = round < s_widen_round ? join : Range::top();
+        is_fixpoint = false;
+      }
+    }
+  }
+}
+
+void RangeAnalysis::export_widths() {
+  struct Class {
+    bool is_top;
+    bool is_signed;
+    bool is_array;
+    unsigned bv_size;
+    unsigned width;
+  };
+
+  std::unordered_map<Node, Class> class_map;
+  for (Node node = 0; node < m_nodes.size(); node++) {
+    const NodeInfo& info = m_nodes[node];
+    const Node root = find(node);
+    const auto class_iter = class_map.find(root);
+    if (class_iter == class_map.end()) {
+      const Class c = {false, info.is_signed, false, info.bv_size, 1};
+      class_map[root] = c;
+    }
+
+    Class& c = class_map[root];
+    c.is_array = c.is_array || info.is_array;
+    c.bv_size = std::min(c.bv_size, info.bv_size);
+    if (c.is_top || info.range.is_top() || c.is_signed != info.is_signed) {
+      c.is_top = true;
+    } else {
+      c.width = std::max(c.width, info.range.bit_width(info.is_signed));
+    }
+  }
+
+  for (std::pair<const Node, Class>& class_value : class_map) {
+    Class& c = class_value.second;
+    if (c.is_array) {
+      c.width = c.width <= 8 ? 8 : c.width <= 16 ? 16 : c.width <= 32 ? 32 : 64;
+    }
+    if (c.bv_size <= c.width) {
+      c.is_top = true;
+    }
+  }
+
+  for (const std::pair<const void* const, Node>& node_value : m_node_map) {
+    const Class& value_class = class_map.at(find(node_value.second));
+    if (!value_class.is_top) {
+      m_value_widths[node_value.first] = value_class.width;
+    }
+
+    const Node index = m_nodes[node_value.second].index;
+    if (index != NONE) {
+      const Class& index_class = class_map.at(find(index));
+      if (!index_class.is_top) {
+        m_index_widths[node_value.first] = index_class.width;
+      }
+    }
+  }
+}
+
+Range RangeAnalysis::range(const void* key) const {
+  const auto node_iter = m_node_map.find(key);
+  if (node_iter == m_node_map.cend()) {
+    return Range();
+  }
+  return m_nodes[node_iter->second].range;
+}
+
+}
@@ -2,17 +2,24 @@
 // Use of this source code is governed by a BSD-style
 // license that can be found in the LICENSE file.
 
-#include "concurrent/thread.h"
+#include "concurrent/session.h"
 
 namespace se {
 
-Threads Threads::s_singleton;
-ThreadId Thread::s_next_thread_id(0);
 const std::shared_ptr<ReadInstr<bool>> Thread::s_true_condition_ptr;
 
+std::atomic<unsigned long long> Threads::s_next_recording_id(0);
+
+ThreadId& Thread::next_thread_id() {
+  return Session::current().m_next_thread_id;
+}
+
+Threads& Threads::singleton() {
+  return Session::current().m_threads;
+}
+
 Encoders& global_encoders() {
-  static Encoders s_encoders;
-  return s_encoders;
+  return Session::current().m_encoders;
 }
 
 namespace ThisThread {
@@ -45,6 +52,31 @@ namespace ThisThread {
   }
 };
 
+void atomic_begin() {
+  Threads::current_thread().atomic_begin();
+}
+
+void atomic_end() {
+  Threads::current_thread().atomic_end();
+}
+
+Thread::Thread(CachedRecording, void (*f)()) :
+  m_thread_id(next_thread_id()++),
+  m_parent_thread_ptr(&Threads::current_thread()),
+  m_send_event_ptr(nullptr),
+  m_condition_ptrs_size(0),
+  m_condition_ptrs(),
+  m_atomic_depth(0) {
+
+  const std::shared_ptr<SendEvent> spawn_event_ptr(Threads::begin_thread(this));
+  const bool is_replayed = Threads::replay_thread(f);
+  m_send_event_ptr = Threads::end_thread();
+
+  if (is_replayed) {
+    Threads::add_symmetric_thread(f, *this, spawn_event_ptr);
+  }
+}
+
 bool Thread::encode() {
   return Threads::encode(Thread::encoders());
 }
@@ -74,6 +106,24 @@ void Thread::end_branch() {
   Threads::slice_end_branch(m_thread_id);
 }
 
+void Thread::atomic_begin() {
+  if (m_atomic_depth++ == 0) {
+    const std::shared_ptr<Event> event_ptr(new RegionEvent(m_thread_id,
+      true, path_condition_ptr()));
+    Threads::slice_append(m_thread_id, event_ptr);
+  }
+}
+
+void Thread::atomic_end() {
+  assert(0 < m_atomic_depth);
+
+  if (--m_atomic_depth == 0) {
+    const std::shared_ptr<Event> event_ptr(new RegionEvent(m_thread_id,
+      false, path_condition_ptr()));
+    Threads::slice_append(m_thread_id, event_ptr);
+  }
+}
+
 std::shared_ptr<ReadInstr<bool>> Thread::path_condition_ptr() {
   if (m_condition_ptrs_size == 0) {
     return s_true_condition_ptr;
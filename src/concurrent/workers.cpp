@@ -0,0 +1,294 @@
+// Copyright 2013, Alex Horn. All rights reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include <atomic>
+#include <vector>
+#include <new>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "concurrent/workers.h"
+
+namespace se {
+
+/// \internal Work queue in memory that is shared by all worker processes
+struct SliceWorkers::Queue {
+  static constexpr unsigned MAX_ITEM_COUNT = 1024;
+  static constexpr unsigned MAX_PIN_COUNT = 64;
+
+  struct Item {
+    unsigned pin_count;
+    BranchPin pins[MAX_PIN_COUNT];
+  };
+
+  // spinlock that guards all other fields
+  std::atomic<bool> is_locked;
+
+  unsigned idle_count;
+  unsigned busy_count;
+  bool is_done;
+  bool is_sat;
+
+  // has a slice been neither sat nor unsat?
+  bool is_unknown;
+  unsigned long long slice_count;
+
+  unsigned item_count;
+  Item items[MAX_ITEM_COUNT];
+
+  Queue() :
+    is_locked(false),
+    idle_count(0),
+    busy_count(0),
+    is_done(false),
+    is_sat(false),
+    is_unknown(false),
+    slice_count(0),
+    item_count(0) {}
+
+  void lock() {
+    while (is_locked.exchange(true, std::memory_order_acquire)) {
+      /* spin */
+    }
+  }
+
+  void unlock() {
+    is_locked.store(false, std::memory_order_release);
+  }
+
+  // \pre lock() has been called
+  bool push(const BranchPins& branch_pins) {
+    if (item_count == MAX_ITEM_COUNT ||
+        MAX_PIN_COUNT < branch_pins.size()) {
+      return false;
+    }
+
+    Item& item = items[item_count++];
+    item.pin_count = 0;
+    for (const BranchPin& branch_pin : branch_pins) {
+      item.pins[item.pin_count++] = branch_pin;
+    }
+    return true;
+  }
+
+  // Waits until there is work, or all work is done
+  bool pop(BranchPins& branch_pins) {
+    lock();
+    while (!is_done) {
+      if (0 < item_count) {
+        const Item& item = items[--item_count];
+        branch_pins.assign(item.pins, item.pins + item.pin_count);
+        busy_count++;
+        unlock();
+        return true;
+      }
+
+      if (busy_count == 0) {
+        is_done = true;
+        break;
+      }
+
+      idle_count++;
+      unlock();
+      usleep(1000);
+      lock();
+      idle_count--;
+    }
+    unlock();
+    return false;
+  }
+
+  void finish() {
+    lock();
+    busy_count--;
+    unlock();
+  }
+
+  void record(smt::CheckResult slice_result) {
+    lock();
+    slice_count++;
+    if (slice_result == smt::sat) {
+      is_sat = true;
+      is_done = true;
+    } else if (slice_result != smt::unsat) {
+      is_unknown = true;
+    }
+    unlock();
+  }
+
+  // \pre all workers have stopped
+  smt::CheckResult result() const {
+    if (is_sat) {
+      return smt::sat;
+    }
+    return is_unknown ? smt::unknown : smt::unsat;
+  }
+
+  bool done() {
+    lock();
+    const bool result = is_done;
+    unlock();
+    return result;
+  }
+};
+
+SliceWorkers::SliceWorkers(Slicer& slicer, unsigned worker_count) :
+  m_slicer(slicer),
+  m_worker_count(worker_count),
+  m_queue_ptr(nullptr),
+  m_is_shared(false) {
+
+  assert(0 < m_worker_count);
+
+  void* ptr = mmap(nullptr, sizeof(Queue), PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    // without shared memory, all slices are explored by the calling process
+    m_queue_ptr = new Queue();
+    return;
+  }
+
+  m_queue_ptr = new (ptr) Queue();
+  m_is_shared = true;
+}
+
+SliceWorkers::~SliceWorkers() {
+  if (!m_is_shared) {
+    delete m_queue_ptr;
+    return;
+  }
+
+  m_queue_ptr->~Queue();
+  munmap(m_queue_ptr, sizeof(Queue));
+}
+
+unsigned long long SliceWorkers::slice_count() const {
+  return m_queue_ptr->slice_count;
+}
+
+void SliceWorkers::work(const SliceFn& slice_fn) {
+  Queue& queue = *m_queue_ptr;
+  Slicer& slicer = m_slicer;
+
+  // hand off unexplored slices to idle workers
+  slicer.set_split_fn([&queue](const BranchPins& split_pins) {
+    bool is_split = false;
+    queue.lock();
+    if (queue.item_count == 0 && 0 < queue.idle_count) {
+      is_split = queue.push(split_pins);
+    }
+    queue.unlock();
+    return is_split;
+  });
+
+  BranchPins branch_pins;
+  while (queue.pop(branch_pins)) {
+    slicer.restart(branch_pins);
+
+    smt::CheckResult slice_result = smt::unsat;
+    do {
+      if (queue.done()) {
+        break;
+      }
+
+      slice_result = slice_fn();
+      queue.record(slice_result);
+    } while (slice_result != smt::sat && slicer.next_slice());
+
+    queue.finish();
+  }
+}
+
+smt::CheckResult SliceWorkers::run(const SliceFn& slice_fn) {
+  Queue& queue = *m_queue_ptr;
+
+  // initially, the queue contains the set of all slices
+  queue.lock();
+  queue.idle_count = 0;
+  queue.busy_count = 0;
+  queue.is_done = false;
+  queue.is_sat = false;
+  queue.is_unknown = false;
+  queue.slice_count = 0;
+  queue.items[0].pin_count = 0;
+  queue.item_count = 1;
+  queue.unlock();
+
+  std::vector<pid_t> pids;
+  for (unsigned k = 0; m_is_shared && k < m_worker_count; k++) {
+    const pid_t pid = fork();
+    if (pid == 0) {
+      work(slice_fn);
+      _exit(0);
+    }
+
+    if (pid < 0) {
+      break;
+    }
+
+    pids.push_back(pid);
+  }
+
+  if (pids.empty()) {
+    work(slice_fn);
+    return queue.result();
+  }
+
+  // a worker that does not exit normally leaves its slices unexplored
+  bool is_complete = true;
+  bool is_stopped = false;
+  std::vector<pid_t> live_pids(pids);
+  while (!live_pids.empty() && !is_stopped) {
+    bool has_exited = false;
+
+    // only reap the workers, never other children of the caller
+    for (size_t k = 0; k < live_pids.size() && !is_stopped; ) {
+      int status;
+      const pid_t pid = waitpid(live_pids[k], &status, WNOHANG);
+      if (pid == 0) {
+        k++;
+        continue;
+      }
+
+      live_pids.erase(live_pids.begin() + k);
+      has_exited = true;
+
+      // never lock the queue after a failure because the failed worker may
+      // have died while holding the lock, or with a busy_count that it
+      // never gives back
+      if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        is_complete = false;
+        is_stopped = true;
+      } else if (queue.done() && queue.is_sat) {
+        is_stopped = true;
+      }
+    }
+
+    if (!has_exited) {
+      usleep(1000);
+    }
+  }
+
+  for (pid_t pid : live_pids) {
+    kill(pid, SIGKILL);
+  }
+  for (pid_t pid : live_pids) {
+    waitpid(pid, nullptr, 0);
+  }
+
+  // all workers have stopped, possibly in the middle of a critical section
+  queue.is_locked.store(false, std::memory_order_release);
+  queue.is_done = true;
+
+  if (!queue.is_sat && !is_complete) {
+    return smt::unknown;
+  }
+  return queue.result();
+}
+
+}
@@ -2,11 +2,14 @@
 // Use of this source code is governed by a BSD-style
 // license that can be found in the LICENSE file.
 
-#include "concurrent/zone.h"
+#include "concurrent/session.h"
 
 namespace se {
 
 Zone Zone::s_bottom_element;
-unsigned Zone::s_next_atom = 0;
+
+unsigned& Zone::next_atom() {
+  return Session::current().m_next_atom;
+}
 
 }
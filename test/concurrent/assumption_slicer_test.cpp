@@ -0,0 +1,165 @@
+#include "concurrent.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+TEST(AssumptionSlicerTest, AlwaysExecuteBothBranches) {
+  Encoders encoders;
+  AssumptionSlicer slicer;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+
+  EXPECT_TRUE(slicer.begin_then_branch(__COUNTER__, any<bool>()));
+  EXPECT_NE(nullptr, ThisThread::path_condition_ptr());
+  EXPECT_TRUE(slicer.begin_else_branch(__COUNTER__));
+  slicer.end_branch(__COUNTER__);
+
+  EXPECT_TRUE(slicer.begin_then_branch(__COUNTER__, any<bool>()));
+  slicer.end_branch(__COUNTER__);
+
+  EXPECT_EQ(2, slicer.location_count());
+  EXPECT_EQ(0, slicer.slice_count());
+
+  Threads::end_main_thread(encoders);
+}
+
+TEST(AssumptionSlicerTest, SatSingleThread) {
+  Encoders encoders;
+  AssumptionSlicer slicer;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  x = 'A';
+  if (slicer.begin_then_branch(__COUNTER__, x == 'A')) {
+    x = 'B';
+  }
+  if (slicer.begin_else_branch(__COUNTER__)) {
+    x = 'C';
+  }
+  slicer.end_branch(__COUNTER__);
+  a = x;
+
+  Threads::error(a == 'B', encoders);
+  EXPECT_TRUE(Threads::end_main_thread(encoders));
+
+  EXPECT_EQ(smt::sat, slicer.check(encoders));
+
+  // first slice takes the "else" branch, the second the "then" branch
+  EXPECT_EQ(2, slicer.slice_count());
+  EXPECT_EQ(0, slicer.pruned_count());
+  EXPECT_EQ(1, slicer.slice());
+
+  // a single slice is left after the first one, so shrinking stops after
+  // one solver call
+  EXPECT_EQ(1, slicer.core_check_count());
+}
+
+TEST(AssumptionSlicerTest, UnsatSingleThread) {
+  Encoders encoders;
+  AssumptionSlicer slicer;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  x = 'A';
+  if (slicer.begin_then_branch(__COUNTER__, x == 'A')) {
+    x = 'B';
+  }
+  if (slicer.begin_else_branch(__COUNTER__)) {
+    x = 'C';
+  }
+  slicer.end_branch(__COUNTER__);
+  if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+    x = 'D';
+  }
+  slicer.end_branch(__COUNTER__);
+  a = x;
+
+  Threads::error(a == 'C', encoders);
+  EXPECT_TRUE(Threads::end_main_thread(encoders));
+
+  EXPECT_EQ(smt::unsat, slicer.check(encoders));
+
+  // neither branch decision is needed for unsatisfiability
+  EXPECT_EQ(1, slicer.slice_count());
+  EXPECT_EQ(3, slicer.pruned_count());
+
+  // pruning takes fewer solver calls than checking all four slices
+  EXPECT_EQ(2, slicer.core_check_count());
+  EXPECT_GT(4, slicer.slice_count() + slicer.core_check_count());
+}
+
+TEST(AssumptionSlicerTest, UnsatSingleThreadWithoutPruning) {
+  Encoders encoders;
+  AssumptionSlicer slicer(false);
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  x = 'A';
+  if (slicer.begin_then_branch(__COUNTER__, x == 'A')) {
+    x = 'B';
+  }
+  if (slicer.begin_else_branch(__COUNTER__)) {
+    x = 'C';
+  }
+  slicer.end_branch(__COUNTER__);
+  if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+    x = 'D';
+  }
+  slicer.end_branch(__COUNTER__);
+  a = x;
+
+  Threads::error(a == 'C', encoders);
+  EXPECT_TRUE(Threads::end_main_thread(encoders));
+
+  EXPECT_EQ(smt::unsat, slicer.check(encoders));
+  EXPECT_EQ(4, slicer.slice_count());
+  EXPECT_EQ(0, slicer.pruned_count());
+  EXPECT_EQ(0, slicer.core_check_count());
+
+  // Gray code of the last slice
+  EXPECT_EQ(2, slicer.slice());
+}
+
+TEST(AssumptionSlicerTest, SatMultipleThreads) {
+  Encoders encoders;
+  AssumptionSlicer slicer;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  x = 'A';
+
+  Threads::begin_thread();
+  if (slicer.begin_then_branch(__COUNTER__, x == 'A')) {
+    x = 'B';
+  }
+  slicer.end_branch(__COUNTER__);
+  Threads::end_thread();
+
+  a = x;
+
+  Threads::error(a == 'B', encoders);
+  EXPECT_TRUE(Threads::end_main_thread(encoders));
+
+  EXPECT_EQ(smt::sat, slicer.check(encoders));
+  EXPECT_EQ(1, slicer.slice());
+}
@@ -0,0 +1,136 @@
+#include "concurrent.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+TEST(EventClonerTest, CloneWriteEvent) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  const unsigned begin_atom = Zone::next_atom();
+  const Zone zone(Zone::unique_atom());
+  const unsigned end_atom = Zone::next_atom();
+
+  const EventId begin_event_id = Event::peek_id();
+  const std::shared_ptr<ReadEvent<int>> read_event_ptr(
+    new ReadEvent<int>(3, zone));
+  std::unique_ptr<ReadInstr<int>> instr_ptr(new BasicReadInstr<int>(
+    read_event_ptr));
+  const std::shared_ptr<Event> write_event_ptr(new DirectWriteEvent<int>(3,
+    zone, std::move(instr_ptr)));
+  const EventId end_event_id = Event::peek_id();
+
+  EventCloner cloner(7, nullptr, begin_event_id, end_event_id,
+    begin_atom, end_atom);
+
+  const std::shared_ptr<Event> clone_ptr(cloner.event_ptr(write_event_ptr));
+  EXPECT_NE(write_event_ptr, clone_ptr);
+  EXPECT_EQ(clone_ptr, cloner.event_ptr(write_event_ptr));
+  EXPECT_EQ(2, cloner.clone_count());
+
+  EXPECT_TRUE(clone_ptr->is_write());
+  EXPECT_EQ(7, clone_ptr->thread_id());
+  EXPECT_LE(end_event_id, clone_ptr->event_id());
+  EXPECT_FALSE(clone_ptr->zone().is_bottom());
+  EXPECT_NE(zone, clone_ptr->zone());
+
+  // the cloned write event reads from the clone of the read event
+  const DirectWriteEvent<int>& clone_write_event =
+    static_cast<const DirectWriteEvent<int>&>(*clone_ptr);
+  const BasicReadInstr<int>& clone_instr =
+    static_cast<const BasicReadInstr<int>&>(clone_write_event.instr_ref());
+  EXPECT_EQ(cloner.event_ptr(read_event_ptr), clone_instr.event_ptr());
+  EXPECT_EQ(clone_ptr->zone(), clone_instr.event_ptr()->zone());
+}
+
+TEST(EventClonerTest, KeepEventOutsideRecording) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  const Zone zone(Zone::unique_atom());
+  const std::shared_ptr<Event> event_ptr(new ReadEvent<int>(3, zone));
+
+  const EventId begin_event_id = Event::peek_id();
+  const unsigned begin_atom = Zone::next_atom();
+  EventCloner cloner(7, nullptr, begin_event_id, begin_event_id,
+    begin_atom, begin_atom);
+
+  EXPECT_EQ(event_ptr, cloner.event_ptr(event_ptr));
+  EXPECT_EQ(zone, cloner.zone(zone));
+  EXPECT_EQ(0, cloner.clone_count());
+}
+
+TEST(EventClonerTest, Bind) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  const std::shared_ptr<Event> event_ptr(new ReadEvent<int>(3, Zone::bottom()));
+  const std::shared_ptr<Event> bind_ptr(new ReadEvent<int>(3, Zone::bottom()));
+
+  EventCloner cloner(3, nullptr, 0, Event::peek_id(), 0, 0);
+  cloner.bind(event_ptr, bind_ptr);
+  EXPECT_EQ(bind_ptr, cloner.event_ptr(event_ptr));
+}
+
+TEST(EventClonerTest, LocalReadEventSharesWriteEventId) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  const EventId begin_event_id = Event::peek_id();
+  LocalVar<int> a;
+  a = 5;
+  const EventId end_event_id = Event::peek_id();
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  std::shared_ptr<Event> write_event_ptr(nullptr);
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (event_ptr->event_id() == a.read_event_ptr()->event_id()) {
+      write_event_ptr = event_ptr;
+    }
+  }
+  ASSERT_NE(nullptr, write_event_ptr);
+
+  EventCloner cloner(3, nullptr, begin_event_id, end_event_id, 0, 0);
+  const std::shared_ptr<Event> clone_ptr(cloner.event_ptr(write_event_ptr));
+  const std::shared_ptr<ReadEvent<int>> clone_read_event_ptr(
+    cloner.read_event_ptr(a.read_event_ptr()));
+
+  EXPECT_NE(write_event_ptr->event_id(), clone_ptr->event_id());
+  EXPECT_EQ(clone_ptr->event_id(), clone_read_event_ptr->event_id());
+  EXPECT_TRUE(clone_read_event_ptr->zone().is_bottom());
+}
+
+TEST(EventClonerTest, ConditionPtr) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  const std::shared_ptr<ReadInstr<bool>> call_condition_ptr(
+    new LiteralReadInstr<bool>(true));
+
+  const EventId begin_event_id = Event::peek_id();
+  const std::shared_ptr<ReadInstr<bool>> condition_ptr(any<bool>());
+  const EventId end_event_id = Event::peek_id();
+
+  EventCloner cloner(3, call_condition_ptr, begin_event_id, end_event_id,
+    0, 0);
+
+  EXPECT_EQ(call_condition_ptr, cloner.condition_ptr(nullptr));
+  EXPECT_EQ(nullptr, cloner.instr_ptr(nullptr));
+
+  const std::shared_ptr<ReadInstr<bool>> clone_ptr(
+    cloner.condition_ptr(condition_ptr));
+  EXPECT_NE(condition_ptr, clone_ptr);
+  EXPECT_NE(call_condition_ptr, clone_ptr);
+  EXPECT_EQ(clone_ptr, cloner.condition_ptr(condition_ptr));
+
+  // path conditions are conjoined with the one of the call site
+  const NaryReadInstr<LAND, bool>& conjunction =
+    static_cast<const NaryReadInstr<LAND, bool>&>(*clone_ptr);
+  EXPECT_EQ(2, conjunction.size());
+  EXPECT_EQ(call_condition_ptr, conjunction.operand_ptrs().front());
+  EXPECT_EQ(cloner.instr_ptr(condition_ptr),
+    *std::next(conjunction.operand_ptrs().cbegin()));
+}
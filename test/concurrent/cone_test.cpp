@@ -0,0 +1,126 @@
+#include "concurrent.h"
+#include "concurrent/cone.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+TEST(DependencyConeTest, SharedAndLocalDependencies) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  SharedVar<int> y;
+  SharedVar<int> z;
+  LocalVar<int> a;
+
+  y = 1;
+  z = 2;
+  x = z;
+  a = x;
+
+  Threads::error(a == 3, encoders);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  const DependencyCone cone(Threads::property_event_ptrs(), event_ptrs);
+
+  EXPECT_FALSE(cone.zone().meet(x.zone()).is_bottom());
+  EXPECT_TRUE(cone.zone().meet(y.zone()).is_bottom());
+  EXPECT_FALSE(cone.zone().meet(z.zone()).is_bottom());
+
+  Threads::end_main_thread(encoders);
+}
+
+TEST(DependencyConeTest, ConditionDependencies) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  SharedVar<int> y;
+  SharedVar<int> z;
+
+  Threads::begin_thread();
+  ThisThread::begin_then(y == 1);
+  x = 2;
+  ThisThread::end_branch();
+  z = 3;
+  Threads::end_thread();
+
+  Threads::error(x == 2, encoders);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  const DependencyCone cone(Threads::property_event_ptrs(), event_ptrs);
+
+  EXPECT_FALSE(cone.zone().meet(x.zone()).is_bottom());
+  EXPECT_FALSE(cone.zone().meet(y.zone()).is_bottom());
+  EXPECT_TRUE(cone.zone().meet(z.zone()).is_bottom());
+
+  Threads::end_main_thread(encoders);
+}
+
+TEST(DependencyConeTest, NoProperties) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  x = 1;
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  const DependencyCone cone(Threads::property_event_ptrs(), event_ptrs);
+
+  EXPECT_TRUE(cone.zone().is_bottom());
+  EXPECT_FALSE(cone.is_relevant(*ThisThread::most_outer_block_ptr(), true));
+
+  Threads::end_main_thread(encoders);
+}
+
+TEST(DependencyConeTest, Overlaps) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  SharedVar<int> y;
+  SharedVar<int> z;
+
+  x = 1;
+  y = x;
+  z = 2;
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  std::forward_list<std::shared_ptr<Event>> x_event_ptrs;
+  std::unique_ptr<ReadInstr<bool>> x_condition(x == 1);
+  x_condition->filter(x_event_ptrs);
+
+  std::forward_list<std::shared_ptr<Event>> y_event_ptrs;
+  std::unique_ptr<ReadInstr<bool>> y_condition(y == 1);
+  y_condition->filter(y_event_ptrs);
+
+  std::forward_list<std::shared_ptr<Event>> z_event_ptrs;
+  std::unique_ptr<ReadInstr<bool>> z_condition(z == 1);
+  z_condition->filter(z_event_ptrs);
+
+  const DependencyCone x_cone(x_event_ptrs, event_ptrs);
+  const DependencyCone y_cone(y_event_ptrs, event_ptrs);
+  const DependencyCone z_cone(z_event_ptrs, event_ptrs);
+
+  // y depends on x
+  EXPECT_TRUE(x_cone.overlaps(y_cone));
+  EXPECT_TRUE(y_cone.overlaps(x_cone));
+  EXPECT_FALSE(x_cone.overlaps(z_cone));
+  EXPECT_FALSE(z_cone.overlaps(y_cone));
+
+  Threads::end_main_thread(encoders);
+}
@@ -0,0 +1,58 @@
+#include "concurrent.h"
+#include "concurrent/cubes.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+// x = 'A' || x = 'B'; a = x; error(a == c)
+static void record(char c, Encoders& encoders) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  Threads::begin_thread();
+  x = 'A';
+  Threads::end_thread();
+
+  Threads::begin_thread();
+  x = 'B';
+  Threads::end_thread();
+
+  a = x;
+  Threads::error(a == c, encoders);
+  Threads::end_main_thread(encoders);
+}
+
+TEST(CubesTest, Split) {
+  Encoders encoders;
+  record('B', encoders);
+
+  const CubeSplitter splitter(2);
+
+  // at least two candidate write events and the disabled read event
+  EXPECT_LE(3, splitter.split(encoders).size());
+
+  const CubeSplitter tiny_splitter(2, 2);
+  EXPECT_EQ(1, tiny_splitter.split(encoders).size());
+}
+
+TEST(CubesTest, Sat) {
+  Encoders encoders;
+  CubeSplitter splitter(2);
+
+  record('B', encoders);
+  EXPECT_EQ(smt::sat, splitter.check(encoders));
+  EXPECT_LE(3, splitter.cube_count());
+}
+
+TEST(CubesTest, Unsat) {
+  Encoders encoders;
+  CubeSplitter splitter(2);
+
+  record('C', encoders);
+  EXPECT_EQ(smt::unsat, splitter.check(encoders));
+  EXPECT_LE(3, splitter.cube_count());
+}
@@ -217,21 +217,15 @@ TEST(EncoderC0Test, Z3ReadClock) {
   const ReadEvent<int> event(thread_id, zone);
 
   encoders.solver.push();
-#ifdef __USE_MATRIX__
-  encoders.solver.unsafe_add(encoders.clock(event).simultaneous_or_happens_before(Clock("epoch"));
-#else
   encoders.solver.unsafe_add(encoders.clock(event).term() <= 0);
-#endif
 
   // Proves that clock values are natural numbers
   EXPECT_EQ(smt::unsat, encoders.solver.check());
 
   // Sanity check a satisfiable formula
   encoders.solver.pop();
-#ifndef __USE_MATRIX__
   encoders.solver.unsafe_add(encoders.clock(event).term() <= 1);
   EXPECT_EQ(smt::sat, encoders.solver.check());
-#endif
 }
 
 TEST(EncoderC0Test, Z3WriteClock) {
@@ -243,21 +237,181 @@ TEST(EncoderC0Test, Z3WriteClock) {
     std::unique_ptr<ReadInstr<int>>(new LiteralReadInstr<int>(42)));
 
   encoders.solver.push();
-#ifdef __USE_MATRIX__
-  encoders.solver.unsafe_add(encoders.clock(event).simultaneous_or_happens_before(Clock("epoch"));
-#else
   encoders.solver.unsafe_add(encoders.clock(event).term() <= 0);
-#endif
 
   // Proves that clock values are natural numbers
   EXPECT_EQ(smt::unsat, encoders.solver.check());
 
   // Sanity check a satisfiable formula
   encoders.solver.pop();
-#ifndef __USE_MATRIX__
   encoders.solver.unsafe_add(encoders.clock(event).term() <= 1);
   EXPECT_EQ(smt::sat, encoders.solver.check());
-#endif
+}
+
+static EncoderOptions matrix_options() {
+  EncoderOptions options;
+  options.happens_before = HappensBefore::MATRIX;
+  return options;
+}
+
+TEST(EncoderC0Test, MatrixClock) {
+  Encoders encoders(matrix_options());
+
+  const unsigned thread_id = 3;
+  const Zone zone = Zone::unique_atom();
+  const ReadEvent<int> event(thread_id, zone);
+
+  encoders.solver.push();
+  encoders.solver.unsafe_add(encoders.clock(event).simultaneous_or_happens_before(
+    encoders.any_clock("epoch")));
+
+  // Proves that every clock happens after the epoch
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+
+  // Sanity check a satisfiable formula
+  encoders.solver.pop();
+  encoders.solver.unsafe_add(encoders.any_clock("epoch").happens_before(
+    encoders.clock(event)));
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+}
+
+TEST(EncoderC0Test, MatrixTransitivity) {
+  Encoders encoders(matrix_options());
+
+  const Clock x(encoders.any_clock("x"));
+  const Clock y(encoders.any_clock("y"));
+  const Clock z(encoders.any_clock("z"));
+
+  // total and asymmetric by construction
+  encoders.solver.push();
+  encoders.solver.unsafe_add(x.happens_before(y) && y.happens_before(x));
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  encoders.solver.pop();
+
+  encoders.solver.unsafe_add(x.happens_before(y) && y.happens_before(z) &&
+    z.happens_before(x));
+
+  // cycles are only ruled out by transitivity
+  encoders.solver.push();
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+  encoders.solver.pop();
+
+  encoders.transitivity();
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+}
+
+TEST(EncoderC0Test, MatrixTransitivityWithFillPairs) {
+  Encoders encoders(matrix_options());
+
+  const Clock a(encoders.any_clock("a"));
+  const Clock b(encoders.any_clock("b"));
+  const Clock c(encoders.any_clock("c"));
+  const Clock d(encoders.any_clock("d"));
+
+  // a cycle of length four has no triangles
+  encoders.solver.unsafe_add(a.happens_before(b) && b.happens_before(c) &&
+    c.happens_before(d) && d.happens_before(a));
+
+  EXPECT_EQ(4, encoders.matrix_ptr()->pair_count());
+  encoders.transitivity();
+  EXPECT_EQ(5, encoders.matrix_ptr()->pair_count());
+  EXPECT_EQ(2, encoders.matrix_ptr()->triangle_count());
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+}
+
+TEST(EncoderC0Test, MatrixTriangleCount) {
+  HappensBeforeMatrix matrix("hb_");
+  smt::Z3Solver solver;
+
+  const unsigned a = matrix.node("a");
+  const unsigned b = matrix.node("b");
+  const unsigned c = matrix.node("c");
+  const unsigned d = matrix.node("d");
+
+  // a path is chordal, so it has neither fill pairs nor triangles
+  matrix.happens_before(a, b);
+  matrix.happens_before(b, c);
+  matrix.happens_before(c, d);
+
+  EXPECT_EQ(5, matrix.node_count());
+  EXPECT_EQ(3, matrix.pair_count());
+  EXPECT_EQ(0, matrix.transitivity(solver));
+  EXPECT_EQ(3, matrix.pair_count());
+  EXPECT_EQ(0, matrix.triangle_count());
+
+  matrix.reset();
+  EXPECT_EQ(1, matrix.node_count());
+  EXPECT_EQ(0, matrix.pair_count());
+
+  // a cycle of length five needs two fill pairs and has three triangles
+  const unsigned v = matrix.node("a");
+  const unsigned w = matrix.node("b");
+  const unsigned x = matrix.node("c");
+  const unsigned y = matrix.node("d");
+  const unsigned z = matrix.node("e");
+
+  matrix.happens_before(v, w);
+  matrix.happens_before(w, x);
+  matrix.happens_before(x, y);
+  matrix.happens_before(y, z);
+  matrix.happens_before(z, v);
+
+  // pairs are unordered
+  matrix.happens_before(w, v);
+
+  EXPECT_EQ(5, matrix.pair_count());
+  EXPECT_EQ(3, matrix.transitivity(solver));
+  EXPECT_EQ(7, matrix.pair_count());
+  EXPECT_EQ(3, matrix.triangle_count());
+
+  // the epoch is never paired
+  matrix.happens_before(HappensBeforeMatrix::s_epoch, v);
+  EXPECT_EQ(7, matrix.pair_count());
+}
+
+TEST(EncoderC0Test, DeferredAxioms) {
+  Encoders encoders;
+
+  const smt::Bool x(smt::any<smt::Bool>("x"));
+  const smt::Bool y(smt::any<smt::Bool>("y"));
+  encoders.solver.add(x);
+
+  encoders.defer(x or y);
+  encoders.defer(not x);
+  encoders.defer(y);
+  EXPECT_EQ(3, encoders.deferred_axiom_count());
+
+  // stops as soon as the formula is unsatisfiable
+  EXPECT_EQ(smt::unsat, encoders.check());
+  EXPECT_EQ(1, encoders.deferred_axiom_count());
+
+  encoders.reset();
+  EXPECT_EQ(0, encoders.deferred_axiom_count());
+
+  encoders.solver.add(x);
+  encoders.defer(x or y);
+  EXPECT_EQ(smt::sat, encoders.check());
+  EXPECT_EQ(0, encoders.deferred_axiom_count());
+}
+
+TEST(EncoderC0Test, Injective) {
+  Encoders encoders;
+
+  const unsigned thread_id = 3;
+  const Zone zone = Zone::unique_atom();
+  const ReadEvent<int> event_x(thread_id, zone);
+  const ReadEvent<int> event_y(thread_id, zone);
+
+  const smt::UnsafeTerm x(encoders.clock(event_x).term());
+  const smt::UnsafeTerm y(encoders.clock(event_y).term());
+  encoders.solver.unsafe_add(encoders.injective({x, y}));
+
+  encoders.solver.push();
+  encoders.solver.unsafe_add(x == y);
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  encoders.solver.pop();
+
+  EXPECT_EQ(smt::sat, encoders.solver.check());
 }
 
 TEST(EncoderC0Test, ReadInstrEncoderForLiteralReadInstr) {
@@ -799,3 +953,81 @@ TEST(EncoderC0Test, Z3OrderEncoderC0ForFrWithoutCondition) {
 
   encoders.solver.pop();
 }
+
+TEST(EncoderC0Test, BvTheory) {
+  EncoderOptions options;
+  options.theory = Theory::BV;
+  Encoders encoders(options);
+
+  const unsigned thread_id = 3;
+  const Zone zone = Zone::unique_atom();
+  const ReadEvent<int> event(thread_id, zone);
+
+  EXPECT_TRUE(event.constant(encoders).sort().is_bv());
+  EXPECT_EQ(TypeInfo<int>::s_type.bv_size(),
+    event.constant(encoders).sort().bv_size());
+
+  EXPECT_TRUE(encoders.clock(event).term().sort().is_bv());
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+}
+
+TEST(EncoderC0Test, IntTheory) {
+  EncoderOptions options;
+  options.theory = Theory::INT;
+  Encoders encoders(options);
+
+  const unsigned thread_id = 3;
+  const Zone zone = Zone::unique_atom();
+  const ReadEvent<int> event(thread_id, zone);
+
+  EXPECT_TRUE(event.constant(encoders).sort().is_int());
+  EXPECT_TRUE(encoders.clock(event).term().sort().is_int());
+}
+
+TEST(EncoderC0Test, SolverBackends) {
+  for (SolverBackend backend : {SolverBackend::Z3, SolverBackend::MSAT,
+      SolverBackend::CVC4}) {
+    EncoderOptions options;
+    options.backend = backend;
+    Encoders encoders(options);
+
+    const short literal = 3;
+    const LiteralReadInstr<short> instr(literal);
+
+    encoders.solver.push();
+    encoders.solver.unsafe_add(encoders.literal(instr) != literal);
+    EXPECT_EQ(smt::unsat, encoders.solver.check());
+    encoders.solver.pop();
+
+    encoders.solver.unsafe_add(encoders.literal(instr) == literal);
+    EXPECT_EQ(smt::sat, encoders.solver.check());
+  }
+}
+
+TEST(EncoderC0Test, BitWidth) {
+  EXPECT_EQ(1, Encoders::bit_width(0));
+  EXPECT_EQ(1, Encoders::bit_width(1));
+  EXPECT_EQ(2, Encoders::bit_width(2));
+  EXPECT_EQ(2, Encoders::bit_width(3));
+  EXPECT_EQ(3, Encoders::bit_width(4));
+  EXPECT_EQ(16, Encoders::bit_width(65535));
+  EXPECT_EQ(17, Encoders::bit_width(65536));
+}
+
+TEST(EncoderC0Test, NarrowClocks) {
+  EncoderOptions options;
+  options.narrow_clocks = true;
+  Encoders encoders(options);
+
+  EXPECT_EQ(0, encoders.clock_width());
+
+  const unsigned thread_id = 3;
+  const Zone zone = Zone::unique_atom();
+  const ReadEvent<int> event(thread_id, zone);
+
+  encoders.bound_clocks(5);
+  EXPECT_EQ(3, encoders.clock_width());
+  EXPECT_TRUE(encoders.clock(event).term().sort().is_bv());
+  EXPECT_EQ(3, encoders.clock(event).term().sort().bv_size());
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+}
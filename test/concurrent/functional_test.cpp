@@ -6,6 +6,23 @@
 using namespace se;
 using namespace se::ops;
 
+// Given options except for one field
+template<typename T>
+static EncoderOptions options_with(EncoderOptions options,
+  T EncoderOptions::*field, typename std::common_type<T>::type value) {
+
+  options.*field = value;
+  return options;
+}
+
+// Default options except for one field
+template<typename T>
+static EncoderOptions options_with(T EncoderOptions::*field,
+  typename std::common_type<T>::type value) {
+
+  return options_with(EncoderOptions(), field, value);
+}
+
 class CharBlockPrinter {
 public:
   std::stringstream out;
@@ -1126,253 +1143,770 @@ TEST(ConcurrentFunctionalTest, UnsatJoinThreads) {
   EXPECT_EQ(smt::unsat, encoders.solver.check());
 }
 
-TEST(ConcurrentFunctionalTest, CopyLocalVar) {
-  Encoders encoders;
+// (x = 'A'; ... ; x = 'A') || join; if (*) x = 'B' else x = 'C'; error(x == c)
+//
+// The thread writes n times, so the number of clocks grows with n.
+static smt::CheckResult check_narrow_clocks(bool narrow_clocks, unsigned n,
+  char c, unsigned& clock_width) {
+
+  Encoders encoders(options_with(&EncoderOptions::narrow_clocks,
+    narrow_clocks));
+  Slicer slicer;
 
   Threads::reset();
   Threads::begin_main_thread();
 
-  LocalVar<char> a = 'A';
-  LocalVar<char> b = a;
+  SharedVar<char> x;
 
-  std::unique_ptr<ReadInstr<bool>> c0(!(b == 'A'));
-  std::unique_ptr<ReadInstr<bool>> c1(!(b == a));
+  Threads::begin_thread();
+  for (unsigned k = 0; k < n; k++) {
+    x = 'A';
+  }
+  const std::shared_ptr<SendEvent> send_event_ptr = Threads::end_thread();
 
-  a = 'B';
-  std::unique_ptr<ReadInstr<bool>> c2(!(b == a));
+  Threads::join(send_event_ptr);
 
-  Threads::end_main_thread(encoders);
+  if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+    x = 'B';
+  }
+  if (slicer.begin_else_branch(__COUNTER__)) {
+    x = 'C';
+  } slicer.end_branch(__COUNTER__);
 
-  encoders.solver.push();
+  Threads::error(x == c, encoders);
 
-  Threads::internal_error(std::move(c0), encoders);
-  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  Threads::end_main_thread(encoders);
 
-  encoders.solver.pop();
+  clock_width = encoders.clock_width();
+  return encoders.solver.check();
+}
 
-  encoders.solver.push();
+TEST(ConcurrentFunctionalTest, NarrowClocksAtPowersOfTwo) {
+  unsigned width = 0;
+  unsigned width_change_count = 0;
 
-  Threads::internal_error(std::move(c1), encoders);
-  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  // the bound grows by one with n, so every new width sits right at the
+  // power of two that needs it
+  for (unsigned n = 1; n <= 36; n++) {
+    const unsigned previous_width = width;
 
-  encoders.solver.pop();
+    unsigned unnarrowed_width;
+    EXPECT_EQ(smt::sat, check_narrow_clocks(false, n, 'B', unnarrowed_width));
+    EXPECT_EQ(smt::sat, check_narrow_clocks(true, n, 'B', width));
+    EXPECT_EQ(0, unnarrowed_width);
 
-  encoders.solver.push();
+    EXPECT_EQ(smt::unsat, check_narrow_clocks(false, n, 'A', unnarrowed_width));
+    EXPECT_EQ(smt::unsat, check_narrow_clocks(true, n, 'A', width));
 
-  Threads::internal_error(std::move(c2), encoders);
-  EXPECT_EQ(smt::sat, encoders.solver.check());
+    EXPECT_LT(0, width);
+    EXPECT_GT(16, width);
+    if (previous_width != 0 && previous_width != width) {
+      EXPECT_EQ(previous_width + 1, width);
+      width_change_count++;
+    }
+  }
 
-  encoders.solver.pop();
+  // the recordings cross at least two powers of two
+  EXPECT_LE(2, width_change_count);
 }
 
-TEST(ConcurrentFunctionalTest, CopySharedVarToLocalVar) {
-  Encoders encoders;
+TEST(ConcurrentFunctionalTest, SatSharedArrayWithNarrowValues) {
+  const EncoderOptions bv_options(options_with(&EncoderOptions::theory,
+    Theory::BV));
+  Encoders encoders(options_with(bv_options, &EncoderOptions::narrow_values,
+    true));
 
   Threads::reset();
   Threads::begin_main_thread();
 
-  SharedVar<char> a = 'A';
-  LocalVar<char> b = a;
+  SharedVar<int[10]> xs;
+  SharedVar<int> x;
 
-  std::unique_ptr<ReadInstr<bool>> c0(b == 'A');
-  std::unique_ptr<ReadInstr<bool>> c1(!(b == 'A'));
+  Threads::begin_thread();
 
-  a = 'B';
-  std::unique_ptr<ReadInstr<bool>> c2(!(b == 'A'));
+  xs[7] = 42;
 
-  Threads::end_main_thread(encoders);
+  Threads::end_thread();
 
-  encoders.solver.push();
+  x = xs[7];
+
+  Threads::error(x == 42, encoders);
+
+  Threads::end_main_thread(encoders);
 
-  Threads::internal_error(std::move(c0), encoders);
   EXPECT_EQ(smt::sat, encoders.solver.check());
+}
 
-  encoders.solver.pop();
+TEST(ConcurrentFunctionalTest, UnsatSharedArrayWithNarrowValues) {
+  const EncoderOptions bv_options(options_with(&EncoderOptions::theory,
+    Theory::BV));
+  Encoders encoders(options_with(bv_options, &EncoderOptions::narrow_values,
+    true));
 
-  encoders.solver.push();
+  Threads::reset();
+  Threads::begin_main_thread();
 
-  Threads::internal_error(std::move(c1), encoders);
-  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  SharedVar<int[10]> xs;
+  SharedVar<int> x;
 
-  encoders.solver.pop();
+  Threads::begin_thread();
 
-  encoders.solver.push();
+  xs[7] = 42;
 
-  Threads::internal_error(std::move(c2), encoders);
-  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  Threads::end_thread();
 
-  encoders.solver.pop();
+  x = xs[7];
+
+  // the array elements are never negative
+  Threads::error(x < 0, encoders);
+
+  Threads::end_main_thread(encoders);
+
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
 }
 
-TEST(ConcurrentFunctionalTest, AnyReadInstr) {
-  Encoders encoders;
+// x = '0'; y = '0'; (x = '1'; y = '1') || (a = y; b = x; error(a == c && b == '0'))
+//
+// If a is '1', then x = '1' happens before y = '1', which happens before
+// a = y, which happens before b = x, which happens before x = '1'. The
+// axioms never compare the accesses of x with those of y in the other
+// thread, so this cycle is only ruled out through a fill pair.
+static smt::CheckResult check_message_passing_with_matrix(char c) {
+  Encoders encoders(options_with(&EncoderOptions::happens_before,
+    HappensBefore::MATRIX));
 
   Threads::reset();
   Threads::begin_main_thread();
 
-  LocalVar<char> a = 'A';
+  SharedVar<char> x;
+  SharedVar<char> y;
+  LocalVar<char> a;
+  LocalVar<char> b;
 
-  a = any<char>();
+  x = '0';
+  y = '0';
 
-  std::unique_ptr<ReadInstr<bool>> c0(a == '*');
-  std::unique_ptr<ReadInstr<bool>> c1(!(a == '*'));
+  Threads::begin_thread();
+  x = '1';
+  y = '1';
+  Threads::end_thread();
 
-  a = '*';
-  std::unique_ptr<ReadInstr<bool>> c2(a == '*');
-  std::unique_ptr<ReadInstr<bool>> c3(!(a == '*'));
+  a = y;
+  b = x;
+
+  Threads::error(a == c && b == '0', encoders);
 
   Threads::end_main_thread(encoders);
 
-  encoders.solver.push();
+  EXPECT_LT(0, encoders.matrix_ptr()->triangle_count());
+  return encoders.solver.check();
+}
 
-  Threads::internal_error(std::move(c0), encoders);
-  EXPECT_EQ(smt::sat, encoders.solver.check());
+TEST(ConcurrentFunctionalTest, SatMessagePassingWithMatrix) {
+  EXPECT_EQ(smt::sat, check_message_passing_with_matrix('0'));
+}
 
-  encoders.solver.pop();
+TEST(ConcurrentFunctionalTest, UnsatMessagePassingWithMatrix) {
+  EXPECT_EQ(smt::unsat, check_message_passing_with_matrix('1'));
+}
 
-  encoders.solver.push();
+TEST(ConcurrentFunctionalTest, SatElseWithoutJoinClocks) {
+  Encoders encoders(options_with(&EncoderOptions::join_clocks, false));
+  Slicer slicer;
 
-  Threads::internal_error(std::move(c1), encoders);
-  EXPECT_EQ(smt::sat, encoders.solver.check());
+  Threads::reset();
+  Threads::begin_main_thread();
 
-  encoders.solver.pop();
+  SharedVar<char> x;
 
-  encoders.solver.push();
+  Threads::begin_thread();
 
-  Threads::internal_error(std::move(c2), encoders);
-  EXPECT_EQ(smt::sat, encoders.solver.check());
+  x = 'A';
 
-  encoders.solver.pop();
+  Threads::end_thread();
 
-  encoders.solver.push();
+  if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+    x = 'B';
+  }
+  if (slicer.begin_else_branch(__COUNTER__)) {
+    x = 'C';
+  } slicer.end_branch(__COUNTER__);
 
-  Threads::internal_error(std::move(c3), encoders);
-  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  Threads::error(x == 'A', encoders);
 
-  encoders.solver.pop();
+  Threads::end_main_thread(encoders);
+
+  EXPECT_EQ(0, encoders.join_clock_count());
+  EXPECT_EQ(smt::sat, encoders.solver.check());
 }
 
-TEST(ConcurrentFunctionalTest, UnsatSlicerZeroConditionalErrorSingleThread) {
-  Encoders encoders;
+TEST(ConcurrentFunctionalTest, UnsatElseWithoutJoinClocks) {
+  Encoders encoders(options_with(&EncoderOptions::join_clocks, false));
   Slicer slicer;
 
   Threads::reset();
   Threads::begin_main_thread();
 
-  SharedVar<int> var;
-  var = any<int>();
+  SharedVar<char> x;
 
-  if (slicer.begin_then_branch(__COUNTER__, 0 < var)) {
-    Threads::error(var == 0, encoders);
+  if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+    x = 'B';
   }
-  slicer.end_branch(__COUNTER__);
+  if (slicer.begin_else_branch(__COUNTER__)) {
+    x = 'C';
+  } slicer.end_branch(__COUNTER__);
+
+  // the read happens after the last write of either branch
+  Threads::error(x == '\0', encoders);
+
   Threads::end_main_thread(encoders);
 
-  EXPECT_FALSE(slicer.next_slice());
-  EXPECT_EQ(1, slicer.slice_count());
+  EXPECT_EQ(0, encoders.join_clock_count());
   EXPECT_EQ(smt::unsat, encoders.solver.check());
 }
 
-TEST(ConcurrentFunctionalTest, UnsatSlicerZeroConditionalErrorMultipleThreads) {
-  Encoders encoders;
-  Slicer slicer;
+TEST(ConcurrentFunctionalTest, SatRefineAxioms) {
+  Encoders encoders(options_with(&EncoderOptions::refine_axioms, true));
 
   Threads::reset();
   Threads::begin_main_thread();
 
-  SharedVar<int> var;
-  var = any<int>();
+  SharedVar<char> x;
+  x = 'A';
 
   Threads::begin_thread();
 
-  if (slicer.begin_then_branch(__COUNTER__, 0 < var)) {
-    Threads::error(var == 0, encoders);
-  }
-  slicer.end_branch(__COUNTER__);
+  x = 'B';
+
+  Threads::end_thread();
+
+  Threads::begin_thread();
+
+  x = 'C';
 
   Threads::end_thread();
+
+  Threads::error(x == 'B', encoders);
+
   Threads::end_main_thread(encoders);
 
-  EXPECT_FALSE(slicer.next_slice());
-  EXPECT_EQ(1, slicer.slice_count());
-  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  EXPECT_LT(0, encoders.deferred_axiom_count());
+  EXPECT_EQ(smt::sat, encoders.check());
+  EXPECT_EQ(0, encoders.deferred_axiom_count());
 }
 
-TEST(ConcurrentFunctionalTest, UnsatSlicerZeroFalseConditionalError) {
-  Encoders encoders;
-  Slicer slicer;
+TEST(ConcurrentFunctionalTest, UnsatRefineAxioms) {
+  Encoders encoders(options_with(&EncoderOptions::refine_axioms, true));
 
   Threads::reset();
   Threads::begin_main_thread();
 
+  SharedVar<char> x;
+
   Threads::begin_thread();
-  if (slicer.begin_then_branch(__COUNTER__, FALSE_READ_INSTR)) {
-    Threads::error(TRUE_READ_INSTR, encoders);
-  }
-  slicer.end_branch(__COUNTER__);
-  Threads::end_thread();
+
+  x = 'A';
+
+  const std::shared_ptr<SendEvent> send_event_ptr = Threads::end_thread();
+
+  Threads::join(send_event_ptr);
+  Threads::error(x == '\0', encoders);
 
   Threads::end_main_thread(encoders);
 
-  EXPECT_FALSE(slicer.next_slice());
-  EXPECT_EQ(1, slicer.slice_count());
-  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  EXPECT_EQ(smt::unsat, encoders.check());
 }
 
-TEST(ConcurrentFunctionalTest, SatSlicerZeroErrorAmongAnotherUnsatError) {
-  Encoders encoders;
-  Slicer slicer;
+TEST(ConcurrentFunctionalTest, SatReadFromSelectors) {
+  Encoders encoders(options_with(&EncoderOptions::read_from,
+    ReadFrom::SELECTORS));
 
   Threads::reset();
   Threads::begin_main_thread();
 
-  if (slicer.begin_then_branch(__COUNTER__, FALSE_READ_INSTR)) {
-    Threads::error(TRUE_READ_INSTR, encoders);
-  }
-  slicer.end_branch(__COUNTER__);
+  SharedVar<char> x;
+  LocalVar<char> a;
 
-  if (slicer.begin_then_branch(__COUNTER__, TRUE_READ_INSTR)) {
-    Threads::error(TRUE_READ_INSTR, encoders);
-  }
-  slicer.end_branch(__COUNTER__);
+  Threads::begin_thread();
+  x = 'A';
+  Threads::end_thread();
+
+  Threads::begin_thread();
+  x = 'B';
+  Threads::end_thread();
+
+  a = x;
+  Threads::error(a == 'B', encoders);
 
   Threads::end_main_thread(encoders);
 
-  EXPECT_FALSE(slicer.next_slice());
-  EXPECT_EQ(1, slicer.slice_count());
   EXPECT_EQ(smt::sat, encoders.solver.check());
 }
 
-TEST(ConcurrentFunctionalTest, SatSlicerMaxInSingleThreadWithSharedVar) {
-  Slicer slicer(MAX_SLICE_FREQ);
+// x = 'A' || x = 'A'; a = x; b = x; error(a == 'A' && b == 'A')
+TEST(ConcurrentFunctionalTest, UnsatReadFromSelectors) {
+  Encoders encoders(options_with(&EncoderOptions::read_from,
+    ReadFrom::SELECTORS));
 
-  bool r0 = false;
-  bool r1 = false;
-  bool r2 = false;
-  bool r3 = false;
-  bool r4 = false;
+  Threads::reset();
+  Threads::begin_main_thread();
 
-  do {
-    Encoders encoders;
+  SharedVar<char> x;
+  LocalVar<char> a;
+  LocalVar<char> b;
 
-    Threads::reset();
-    Threads::begin_main_thread();
+  Threads::begin_thread();
+  x = 'A';
+  Threads::end_thread();
 
-    SharedVar<char> x;
-    LocalVar<char> a;
+  Threads::begin_thread();
+  x = 'A';
+  Threads::end_thread();
 
-    x = 'A';
-    if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
-      x = 'B';
+  a = x;
+  b = x;
+  Threads::error(a == 'A' && b == 'A', encoders);
+
+  Threads::end_thread();
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  std::vector<const Event*> write_event_ptrs;
+  std::vector<const Event*> read_event_ptrs;
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (event_ptr->is_sync() || event_ptr->zone().is_bottom()) {
+      continue;
     }
-    if (slicer.begin_else_branch(__COUNTER__)) {
-      x = 'C';
+
+    if (event_ptr->is_write()) {
+      write_event_ptrs.push_back(event_ptr.get());
+    } else {
+      read_event_ptrs.push_back(event_ptr.get());
     }
-    slicer.end_branch(__COUNTER__);
-    a = x;
+  }
 
-    // Create properties within main thread context
-    std::unique_ptr<ReadInstr<bool>> c0(a == 'B');
+  ASSERT_EQ(2, write_event_ptrs.size());
+  ASSERT_EQ(2, read_event_ptrs.size());
+
+  const Event& write_event_a = *write_event_ptrs[0];
+  const Event& write_event_b = *write_event_ptrs[1];
+  const Event& read_event_a = *read_event_ptrs[0];
+  const Event& read_event_b = *read_event_ptrs[1];
+
+  EXPECT_TRUE(Threads::encode(encoders));
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+
+  // a read event reads from at most one write event, even if both write
+  // events write the same value
+  encoders.solver.push();
+  encoders.solver.unsafe_add(encoders.rf(write_event_a, read_event_a) &&
+    encoders.rf(write_event_b, read_event_a));
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  encoders.solver.pop();
+
+  // a write event is read by at most one read event
+  encoders.solver.push();
+  encoders.solver.unsafe_add(encoders.rf(write_event_a, read_event_a) &&
+    encoders.rf(write_event_a, read_event_b));
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+  encoders.solver.pop();
+}
+
+// x = 'A' || x = 'B'; a = x; error(a == c)
+static smt::CheckResult check_distinctness(Distinctness distinctness, char c) {
+  Encoders encoders(options_with(&EncoderOptions::distinctness,
+    distinctness));
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  Threads::begin_thread();
+  x = 'A';
+  Threads::end_thread();
+
+  Threads::begin_thread();
+  x = 'B';
+  Threads::end_thread();
+
+  a = x;
+  Threads::error(a == c, encoders);
+
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(ConcurrentFunctionalTest, Distinctness) {
+  const Distinctness distinctnesses[] = {Distinctness::DISTINCT,
+    Distinctness::PAIRWISE, Distinctness::INJECTION, Distinctness::LAZY};
+
+  for (Distinctness distinctness : distinctnesses) {
+    EXPECT_EQ(smt::sat, check_distinctness(distinctness, 'A'));
+    EXPECT_EQ(smt::sat, check_distinctness(distinctness, 'B'));
+    EXPECT_EQ(smt::unsat, check_distinctness(distinctness, 'C'));
+  }
+}
+
+// x = 'A' || y = 'B'; error(x == c); error(y == d)
+static void record_components(char c, char d, Encoders& encoders) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  SharedVar<char> y;
+
+  Threads::begin_thread();
+  x = 'A';
+  Threads::end_thread();
+
+  Threads::begin_thread();
+  y = 'B';
+  Threads::end_thread();
+
+  Threads::error(x == c, encoders);
+  Threads::error(y == d, encoders);
+  Threads::end_thread();
+}
+
+TEST(ConcurrentFunctionalTest, SatComponents) {
+  Encoders encoders;
+
+  record_components('Z', 'B', encoders);
+  EXPECT_EQ(smt::sat, Threads::check_components(encoders));
+
+  record_components('A', 'Z', encoders);
+  EXPECT_EQ(smt::sat, Threads::check_components(encoders));
+}
+
+TEST(ConcurrentFunctionalTest, UnsatComponents) {
+  Encoders encoders;
+
+  record_components('Z', 'Z', encoders);
+  EXPECT_EQ(smt::unsat, Threads::check_components(encoders));
+}
+
+// x = 'A' || y = 'B'; a = y; b = y; error(x == 'A')
+static void record_unrelated_reads(Encoders& encoders) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  SharedVar<char> y;
+  LocalVar<char> a;
+  LocalVar<char> b;
+
+  Threads::begin_thread();
+  x = 'A';
+  y = 'B';
+  Threads::end_thread();
+
+  // two reads but only one write of y, which is unrelated to the error
+  a = y;
+  b = y;
+
+  Threads::error(x == 'A', encoders);
+  Threads::end_thread();
+}
+
+TEST(ConcurrentFunctionalTest, UnsatUnrelatedReadsComponents) {
+  Encoders encoders;
+
+  record_unrelated_reads(encoders);
+  EXPECT_TRUE(Threads::encode(encoders));
+  EXPECT_EQ(smt::unsat, encoders.check());
+
+  encoders.reset();
+  record_unrelated_reads(encoders);
+  EXPECT_EQ(smt::unsat, Threads::check_components(encoders));
+}
+
+// x = '0'; y = '0'; (x = '1'; y = '1') || (expect(y == '1'); error(x == c))
+static void record_expect_components(char c, Encoders& encoders) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  SharedVar<char> y;
+
+  x = '0';
+  y = '0';
+
+  Threads::begin_thread();
+  x = '1';
+  y = '1';
+  Threads::end_thread();
+
+  // the expect condition shares no memory with the error condition
+  Threads::expect(y == '1', encoders);
+  Threads::error(x == c, encoders);
+  Threads::end_thread();
+}
+
+TEST(ConcurrentFunctionalTest, SatExpectComponents) {
+  Encoders encoders;
+
+  record_expect_components('1', encoders);
+  EXPECT_EQ(smt::sat, Threads::check_components(encoders));
+}
+
+TEST(ConcurrentFunctionalTest, UnsatExpectComponents) {
+  Encoders encoders;
+
+  record_expect_components('0', encoders);
+  EXPECT_EQ(smt::unsat, Threads::check_components(encoders));
+}
+
+TEST(ConcurrentFunctionalTest, CopyLocalVar) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  LocalVar<char> a = 'A';
+  LocalVar<char> b = a;
+
+  std::unique_ptr<ReadInstr<bool>> c0(!(b == 'A'));
+  std::unique_ptr<ReadInstr<bool>> c1(!(b == a));
+
+  a = 'B';
+  std::unique_ptr<ReadInstr<bool>> c2(!(b == a));
+
+  Threads::end_main_thread(encoders);
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c0), encoders);
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+
+  encoders.solver.pop();
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c1), encoders);
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+
+  encoders.solver.pop();
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c2), encoders);
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+
+  encoders.solver.pop();
+}
+
+TEST(ConcurrentFunctionalTest, CopySharedVarToLocalVar) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> a = 'A';
+  LocalVar<char> b = a;
+
+  std::unique_ptr<ReadInstr<bool>> c0(b == 'A');
+  std::unique_ptr<ReadInstr<bool>> c1(!(b == 'A'));
+
+  a = 'B';
+  std::unique_ptr<ReadInstr<bool>> c2(!(b == 'A'));
+
+  Threads::end_main_thread(encoders);
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c0), encoders);
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+
+  encoders.solver.pop();
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c1), encoders);
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+
+  encoders.solver.pop();
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c2), encoders);
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+
+  encoders.solver.pop();
+}
+
+TEST(ConcurrentFunctionalTest, AnyReadInstr) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  LocalVar<char> a = 'A';
+
+  a = any<char>();
+
+  std::unique_ptr<ReadInstr<bool>> c0(a == '*');
+  std::unique_ptr<ReadInstr<bool>> c1(!(a == '*'));
+
+  a = '*';
+  std::unique_ptr<ReadInstr<bool>> c2(a == '*');
+  std::unique_ptr<ReadInstr<bool>> c3(!(a == '*'));
+
+  Threads::end_main_thread(encoders);
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c0), encoders);
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+
+  encoders.solver.pop();
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c1), encoders);
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+
+  encoders.solver.pop();
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c2), encoders);
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+
+  encoders.solver.pop();
+
+  encoders.solver.push();
+
+  Threads::internal_error(std::move(c3), encoders);
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+
+  encoders.solver.pop();
+}
+
+TEST(ConcurrentFunctionalTest, UnsatSlicerZeroConditionalErrorSingleThread) {
+  Encoders encoders;
+  Slicer slicer;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> var;
+  var = any<int>();
+
+  if (slicer.begin_then_branch(__COUNTER__, 0 < var)) {
+    Threads::error(var == 0, encoders);
+  }
+  slicer.end_branch(__COUNTER__);
+  Threads::end_main_thread(encoders);
+
+  EXPECT_FALSE(slicer.next_slice());
+  EXPECT_EQ(1, slicer.slice_count());
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+}
+
+TEST(ConcurrentFunctionalTest, UnsatSlicerZeroConditionalErrorMultipleThreads) {
+  Encoders encoders;
+  Slicer slicer;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> var;
+  var = any<int>();
+
+  Threads::begin_thread();
+
+  if (slicer.begin_then_branch(__COUNTER__, 0 < var)) {
+    Threads::error(var == 0, encoders);
+  }
+  slicer.end_branch(__COUNTER__);
+
+  Threads::end_thread();
+  Threads::end_main_thread(encoders);
+
+  EXPECT_FALSE(slicer.next_slice());
+  EXPECT_EQ(1, slicer.slice_count());
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+}
+
+TEST(ConcurrentFunctionalTest, UnsatSlicerZeroFalseConditionalError) {
+  Encoders encoders;
+  Slicer slicer;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  Threads::begin_thread();
+  if (slicer.begin_then_branch(__COUNTER__, FALSE_READ_INSTR)) {
+    Threads::error(TRUE_READ_INSTR, encoders);
+  }
+  slicer.end_branch(__COUNTER__);
+  Threads::end_thread();
+
+  Threads::end_main_thread(encoders);
+
+  EXPECT_FALSE(slicer.next_slice());
+  EXPECT_EQ(1, slicer.slice_count());
+  EXPECT_EQ(smt::unsat, encoders.solver.check());
+}
+
+TEST(ConcurrentFunctionalTest, SatSlicerZeroErrorAmongAnotherUnsatError) {
+  Encoders encoders;
+  Slicer slicer;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  if (slicer.begin_then_branch(__COUNTER__, FALSE_READ_INSTR)) {
+    Threads::error(TRUE_READ_INSTR, encoders);
+  }
+  slicer.end_branch(__COUNTER__);
+
+  if (slicer.begin_then_branch(__COUNTER__, TRUE_READ_INSTR)) {
+    Threads::error(TRUE_READ_INSTR, encoders);
+  }
+  slicer.end_branch(__COUNTER__);
+
+  Threads::end_main_thread(encoders);
+
+  EXPECT_FALSE(slicer.next_slice());
+  EXPECT_EQ(1, slicer.slice_count());
+  EXPECT_EQ(smt::sat, encoders.solver.check());
+}
+
+TEST(ConcurrentFunctionalTest, SatSlicerMaxInSingleThreadWithSharedVar) {
+  Slicer slicer(MAX_SLICE_FREQ);
+
+  bool r0 = false;
+  bool r1 = false;
+  bool r2 = false;
+  bool r3 = false;
+  bool r4 = false;
+
+  do {
+    Encoders encoders;
+
+    Threads::reset();
+    Threads::begin_main_thread();
+
+    SharedVar<char> x;
+    LocalVar<char> a;
+
+    x = 'A';
+    if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+      x = 'B';
+    }
+    if (slicer.begin_else_branch(__COUNTER__)) {
+      x = 'C';
+    }
+    slicer.end_branch(__COUNTER__);
+    a = x;
+
+    // Create properties within main thread context
+    std::unique_ptr<ReadInstr<bool>> c0(a == 'B');
     std::unique_ptr<ReadInstr<bool>> c1(!(a == 'C'));
     std::unique_ptr<ReadInstr<bool>> c2(a == 'B' && !(a == 'C'));
     std::unique_ptr<ReadInstr<bool>> c3(a == 'C');
@@ -1724,3 +2258,446 @@ TEST(ConcurrentFunctionalTest, SatSlicerMaxErrorAmongAnotherUnsatError) {
   EXPECT_EQ(0, unknown_checks);
   EXPECT_EQ(1, unchecks);
 }
+
+TEST(ConcurrentFunctionalTest, UnsatSlicerMaxRelevantOnly) {
+  Slicer slicer(MAX_SLICE_FREQ, true);
+
+  unsigned checks = 0;
+
+  do {
+    Encoders encoders;
+
+    Threads::reset();
+    Threads::begin_main_thread();
+
+    SharedVar<int> x;
+    SharedVar<int> y;
+
+    // irrelevant to the error condition
+    if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+      y = 1;
+    }
+    if (slicer.begin_else_branch(__COUNTER__)) {
+      y = 2;
+    }
+    slicer.end_branch(__COUNTER__);
+
+    // irrelevant to the error condition
+    if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+      y = 3;
+    }
+    slicer.end_branch(__COUNTER__);
+
+    x = 1;
+    Threads::error(x == 0, encoders);
+
+    if (Threads::end_main_thread(encoders)) {
+      checks++;
+      EXPECT_EQ(smt::unsat, encoders.solver.check());
+    }
+  } while (slicer.next_slice());
+
+  // once both blocks of a location are seen, the location is merged
+  EXPECT_EQ(3, slicer.slice_count());
+  EXPECT_EQ(3, checks);
+}
+
+TEST(ConcurrentFunctionalTest, SatSlicerMaxRelevantOnly) {
+  Slicer slicer(MAX_SLICE_FREQ, true);
+
+  unsigned sat_checks = 0;
+
+  do {
+    Encoders encoders;
+
+    Threads::reset();
+    Threads::begin_main_thread();
+
+    SharedVar<int> x;
+
+    x = 1;
+    if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+      x = 0;
+    }
+    slicer.end_branch(__COUNTER__);
+
+    if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+      x = 2;
+    }
+    slicer.end_branch(__COUNTER__);
+
+    Threads::error(x == 0, encoders);
+
+    if (Threads::end_main_thread(encoders) &&
+        smt::sat == encoders.solver.check()) {
+      sat_checks++;
+    }
+  } while (slicer.next_slice());
+
+  // both branch locations write to the zone of the error condition
+  EXPECT_EQ(4, slicer.slice_count());
+  EXPECT_EQ(1, sat_checks);
+}
+
+static unsigned record_budget_slices(Slicer& slicer, unsigned& checks) {
+  unsigned recordings = 0;
+  checks = 0;
+
+  do {
+    Encoders encoders;
+
+    Threads::reset();
+    Threads::begin_main_thread();
+
+    SharedVar<int> x;
+
+    x = 1;
+    if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+      x = 2;
+      x = 3;
+    }
+    if (slicer.begin_else_branch(__COUNTER__)) {
+      x = 4;
+    }
+    slicer.end_branch(__COUNTER__);
+
+    Threads::error(x == 0, encoders);
+    recordings++;
+
+    if (!slicer.within_budget()) {
+      continue;
+    }
+
+    if (Threads::end_main_thread(encoders)) {
+      checks++;
+      EXPECT_EQ(smt::unsat, encoders.solver.check());
+    }
+  } while (slicer.next_slice());
+
+  return recordings;
+}
+
+// Every event is in the zone of `x`. With both branches merged, there are
+// five write events (including the initialization) and one read event, so
+// the estimate is 5 read-from pairs plus 1*1*5*4 stack instances. The slices
+// of the then and else branch have an estimate of 4+12 and 3+6, respectively.
+TEST(ConcurrentFunctionalTest, UnsatSlicerWithinBudget) {
+  Slicer slicer(SliceBudget{25});
+  unsigned checks;
+
+  EXPECT_EQ(1, record_budget_slices(slicer, checks));
+  EXPECT_EQ(1, slicer.slice_count());
+  EXPECT_EQ(1, checks);
+}
+
+TEST(ConcurrentFunctionalTest, UnsatSlicerExceedsBudget) {
+  Slicer slicer(SliceBudget{24});
+  unsigned checks;
+
+  // the first recording is discarded
+  EXPECT_EQ(3, record_budget_slices(slicer, checks));
+  EXPECT_EQ(2, slicer.slice_count());
+  EXPECT_EQ(2, checks);
+}
+
+static SharedVar<int>* s_cached_counter_ptr;
+
+static void increment_cached_counter() {
+  SharedVar<int>& counter = *s_cached_counter_ptr;
+  counter = counter + 1;
+}
+
+// two threads that are spawned from the same recording race on the counter
+static smt::CheckResult check_cached_recording(int c) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> counter(0);
+  s_cached_counter_ptr = &counter;
+
+  Thread t1(cached_recording, increment_cached_counter);
+  Thread t2(cached_recording, increment_cached_counter);
+  t1.join();
+  t2.join();
+
+  Threads::error(counter == c, encoders);
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(ConcurrentFunctionalTest, CachedRecording) {
+  EXPECT_EQ(smt::sat, check_cached_recording(1));
+  EXPECT_EQ(smt::sat, check_cached_recording(2));
+  EXPECT_EQ(smt::unsat, check_cached_recording(0));
+  EXPECT_EQ(smt::unsat, check_cached_recording(3));
+}
+
+// three threads that are spawned from the same recording race on the counter
+static smt::CheckResult check_symmetry(bool break_symmetry, int c) {
+  Encoders encoders(options_with(&EncoderOptions::break_symmetry,
+    break_symmetry));
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> counter(0);
+  s_cached_counter_ptr = &counter;
+
+  Thread t1(cached_recording, increment_cached_counter);
+  Thread t2(cached_recording, increment_cached_counter);
+  Thread t3(cached_recording, increment_cached_counter);
+  t1.join();
+  t2.join();
+  t3.join();
+
+  Threads::error(counter == c, encoders);
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(ConcurrentFunctionalTest, BreakSymmetry) {
+  for (bool break_symmetry : {false, true}) {
+    EXPECT_EQ(smt::unsat, check_symmetry(break_symmetry, 0));
+    EXPECT_EQ(smt::sat, check_symmetry(break_symmetry, 1));
+    EXPECT_EQ(smt::sat, check_symmetry(break_symmetry, 2));
+    EXPECT_EQ(smt::sat, check_symmetry(break_symmetry, 3));
+    EXPECT_EQ(smt::unsat, check_symmetry(break_symmetry, 4));
+  }
+}
+
+// the main thread writes the counter between the two spawns
+static smt::CheckResult check_asymmetric_spawns(int c) {
+  Encoders encoders(options_with(&EncoderOptions::break_symmetry,
+    true));
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> counter(0);
+  s_cached_counter_ptr = &counter;
+
+  Thread t1(cached_recording, increment_cached_counter);
+  counter = 10;
+  Thread t2(cached_recording, increment_cached_counter);
+  t1.join();
+  t2.join();
+
+  Threads::error(counter == c, encoders);
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(ConcurrentFunctionalTest, BreakSymmetryOnlyOfAdjacentSpawns) {
+  // t1 reads zero before the main thread's write, but writes last
+  EXPECT_EQ(smt::sat, check_asymmetric_spawns(1));
+  EXPECT_EQ(smt::sat, check_asymmetric_spawns(11));
+  EXPECT_EQ(smt::sat, check_asymmetric_spawns(12));
+  EXPECT_EQ(smt::unsat, check_asymmetric_spawns(10));
+}
+
+// one thread writes 'A' and then 'B' to x while another one reads it
+static smt::CheckResult check_atomic_section(bool is_atomic, char c) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+
+  Threads::begin_thread();
+  if (is_atomic) {
+    atomic_begin();
+  }
+  x = 'A';
+  x = 'B';
+  if (is_atomic) {
+    atomic_end();
+  }
+  Threads::end_thread();
+
+  Threads::begin_thread();
+  Threads::error(x == c, encoders);
+  Threads::end_thread();
+
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(ConcurrentFunctionalTest, AtomicSection) {
+  EXPECT_EQ(smt::sat, check_atomic_section(false, 'A'));
+  EXPECT_EQ(smt::unsat, check_atomic_section(true, 'A'));
+  EXPECT_EQ(smt::sat, check_atomic_section(true, 'B'));
+}
+
+TEST(ConcurrentFunctionalTest, NestedAtomicSections) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+
+  atomic_begin();
+  x = 'A';
+  atomic_begin();
+  x = 'B';
+  atomic_end();
+  atomic_end();
+
+  // only the outermost atomic section has region events
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  unsigned region_event_count = 0;
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (event_ptr->is_region()) {
+      region_event_count++;
+    }
+  }
+  EXPECT_EQ(2, region_event_count);
+}
+
+// x = 0; two threads increment x and keep the previous values in a and b
+static smt::CheckResult check_fetch_add(int c) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  LocalVar<int> a;
+  LocalVar<int> b;
+
+  Threads::begin_thread();
+  a = x.fetch_add(1);
+  const std::shared_ptr<SendEvent> t1_send_event_ptr(Threads::end_thread());
+
+  Threads::begin_thread();
+  b = x.fetch_add(1);
+  const std::shared_ptr<SendEvent> t2_send_event_ptr(Threads::end_thread());
+
+  Threads::join(t1_send_event_ptr);
+  Threads::join(t2_send_event_ptr);
+
+  Threads::error(a + b == c && x == 2, encoders);
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(ConcurrentFunctionalTest, FetchAdd) {
+  EXPECT_EQ(smt::unsat, check_fetch_add(0));
+  EXPECT_EQ(smt::sat, check_fetch_add(1));
+  EXPECT_EQ(smt::unsat, check_fetch_add(2));
+}
+
+// x = 0; two threads try to replace 0 by 1 and 2, respectively
+static smt::CheckResult check_compare_exchange(bool is_both, int c) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  LocalVar<bool> a;
+  LocalVar<bool> b;
+
+  Threads::begin_thread();
+  a = x.compare_exchange(0, 1);
+  const std::shared_ptr<SendEvent> t1_send_event_ptr(Threads::end_thread());
+
+  Threads::begin_thread();
+  b = x.compare_exchange(0, 2);
+  const std::shared_ptr<SendEvent> t2_send_event_ptr(Threads::end_thread());
+
+  Threads::join(t1_send_event_ptr);
+  Threads::join(t2_send_event_ptr);
+
+  if (is_both) {
+    Threads::error(a && b, encoders);
+  } else {
+    Threads::error(x == c, encoders);
+  }
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(ConcurrentFunctionalTest, CompareExchange) {
+  EXPECT_EQ(smt::unsat, check_compare_exchange(true, 0));
+  EXPECT_EQ(smt::unsat, check_compare_exchange(false, 0));
+  EXPECT_EQ(smt::sat, check_compare_exchange(false, 1));
+  EXPECT_EQ(smt::sat, check_compare_exchange(false, 2));
+}
+
+TEST(ConcurrentFunctionalTest, Exchange) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x(3);
+  LocalVar<int> a;
+  a = x.exchange(5);
+
+  Threads::error(!(a == 3) || !(x == 5), encoders);
+  Threads::end_main_thread(encoders);
+
+  EXPECT_EQ(smt::unsat, encoders.check());
+}
+
+// x = 0; thread 1 writes 1 and thread 2 checks whether x is c, which takes
+// at least two context switches after the main thread has spawned both
+static void encode_contexts(int c, Encoders& encoders) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+
+  Threads::begin_thread();
+  x = 1;
+  Threads::end_thread();
+
+  Threads::begin_thread();
+  Threads::error(x == c, encoders);
+  Threads::end_thread();
+
+  Threads::end_main_thread(encoders);
+}
+
+static smt::CheckResult check_context_bound(unsigned bound) {
+  Encoders encoders(options_with(&EncoderOptions::context_bound, 2u));
+  encode_contexts(1, encoders);
+
+  encoders.solver.push();
+  encoders.solver.unsafe_add(encoders.context_bound(bound));
+  const smt::CheckResult result = encoders.solver.check();
+  encoders.solver.pop();
+  return result;
+}
+
+TEST(ConcurrentFunctionalTest, ContextBound) {
+  EXPECT_EQ(smt::unsat, check_context_bound(0));
+  EXPECT_EQ(smt::unsat, check_context_bound(1));
+  EXPECT_EQ(smt::sat, check_context_bound(2));
+}
+
+TEST(ConcurrentFunctionalTest, ContextBoundFallback) {
+  // the error is found within the bound
+  Encoders bounded_encoders(options_with(&EncoderOptions::context_bound, 2u));
+  encode_contexts(1, bounded_encoders);
+  EXPECT_EQ(smt::sat, bounded_encoders.check());
+
+  // beyond the bound, the unbounded encoding is checked
+  Encoders fallback_encoders(options_with(&EncoderOptions::context_bound, 1u));
+  encode_contexts(1, fallback_encoders);
+  EXPECT_EQ(smt::sat, fallback_encoders.check());
+
+  Encoders unsat_encoders(options_with(&EncoderOptions::context_bound, 2u));
+  encode_contexts(2, unsat_encoders);
+  EXPECT_EQ(smt::unsat, unsat_encoders.check());
+}
@@ -349,3 +349,70 @@ TEST(MutexTest, UnsatJoinMultipleWriters) {
 
   EXPECT_EQ(smt::unsat, encoders.solver.check());
 }
+
+TEST(MutexTest, LockEvents) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  InternalMutex mutex;
+  Encoders encoders;
+
+  mutex.lock();
+  mutex.unlock(encoders);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  unsigned lock_count = 0;
+  unsigned unlock_count = 0;
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    // the mutex is not shared memory
+    EXPECT_TRUE(event_ptr->zone().is_bottom());
+
+    if (event_ptr->is_region()) {
+      const LockEvent& lock_event = static_cast<const LockEvent&>(*event_ptr);
+      EXPECT_EQ(&mutex, lock_event.mutex_ptr());
+      if (lock_event.is_lock()) {
+        lock_count++;
+      } else {
+        unlock_count++;
+      }
+    }
+  }
+
+  EXPECT_EQ(1, lock_count);
+  EXPECT_EQ(1, unlock_count);
+}
+
+// Thread 1 acquires a mutex and never releases it
+static smt::CheckResult check_held_mutex(bool is_same_mutex) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  InternalMutex held_mutex;
+  InternalMutex other_mutex;
+  InternalMutex& mutex = is_same_mutex ? held_mutex : other_mutex;
+
+  Threads::begin_thread();
+  held_mutex.lock();
+  x = 1;
+  Threads::end_thread();
+
+  Threads::begin_thread();
+  mutex.lock();
+  Threads::error(x == 1, encoders);
+  mutex.unlock(encoders);
+  Threads::end_thread();
+
+  Threads::end_main_thread(encoders);
+
+  return encoders.solver.check();
+}
+
+TEST(MutexTest, HeldMutex) {
+  EXPECT_EQ(smt::unsat, check_held_mutex(true));
+  EXPECT_EQ(smt::sat, check_held_mutex(false));
+}
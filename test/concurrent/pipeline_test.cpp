@@ -0,0 +1,63 @@
+#include "concurrent.h"
+#include "concurrent/pipeline.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+// x = 'A'; if (*) { x = 'B'; } a = x; error(a == c)
+static bool record_slice(Slicer& slicer, char c, Encoders& encoders) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  x = 'A';
+  if (slicer.begin_then_branch(__COUNTER__, any<bool>())) {
+    x = 'B';
+  }
+  slicer.end_branch(__COUNTER__);
+  a = x;
+
+  Threads::error(a == c, encoders);
+  return Threads::end_main_thread(encoders);
+}
+
+TEST(SlicePipelineTest, Sat) {
+  Slicer slicer(MAX_SLICE_FREQ);
+  SlicePipeline pipeline(slicer);
+
+  EXPECT_EQ(smt::sat, pipeline.run([&slicer](Encoders& encoders) {
+    return record_slice(slicer, 'B', encoders);
+  }));
+
+  // first slice takes the "else" branch
+  EXPECT_EQ(2, pipeline.slice_count());
+  EXPECT_EQ(2, pipeline.sat_slice());
+}
+
+TEST(SlicePipelineTest, Unsat) {
+  Slicer slicer(MAX_SLICE_FREQ);
+  SlicePipeline pipeline(slicer, 4);
+
+  EXPECT_EQ(smt::unsat, pipeline.run([&slicer](Encoders& encoders) {
+    return record_slice(slicer, 'C', encoders);
+  }));
+
+  EXPECT_EQ(2, pipeline.slice_count());
+  EXPECT_EQ(0, pipeline.sat_slice());
+}
+
+TEST(SlicePipelineTest, NoErrorConditions) {
+  Slicer slicer(MAX_SLICE_FREQ);
+  SlicePipeline pipeline(slicer);
+
+  EXPECT_EQ(smt::unsat, pipeline.run([&slicer](Encoders& encoders) {
+    Threads::reset();
+    Threads::begin_main_thread();
+    return Threads::end_main_thread(encoders);
+  }));
+
+  EXPECT_EQ(1, pipeline.slice_count());
+}
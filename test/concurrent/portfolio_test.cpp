@@ -0,0 +1,63 @@
+#include "concurrent.h"
+#include "concurrent/portfolio.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+static std::vector<PortfolioConfig> configs() {
+  PortfolioConfig conjoined_config;
+  conjoined_config.name = "conjoined";
+
+  PortfolioConfig split_config;
+  split_config.name = "split";
+  split_config.options.split_axioms = true;
+
+  return {conjoined_config, split_config};
+}
+
+// x = 'A' || y = 'B'; a = x; error(a == c)
+static void record(char c, Encoders& encoders) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  Threads::begin_thread();
+  x = 'A';
+  Threads::end_thread();
+
+  Threads::begin_thread();
+  x = 'B';
+  Threads::end_thread();
+
+  a = x;
+  Threads::error(a == c, encoders);
+  Threads::end_thread();
+}
+
+TEST(PortfolioTest, Sat) {
+  Encoders encoders;
+  Portfolio portfolio(configs());
+
+  record('B', encoders);
+  EXPECT_EQ(smt::sat, portfolio.check());
+
+  ASSERT_NE(Portfolio::NO_WINNER, portfolio.winner());
+  EXPECT_EQ(1, portfolio.win_count(portfolio.winner()));
+  EXPECT_EQ(1, portfolio.win_count(0) + portfolio.win_count(1));
+}
+
+TEST(PortfolioTest, Unsat) {
+  Encoders encoders;
+  Portfolio portfolio(configs());
+
+  record('C', encoders);
+  EXPECT_EQ(smt::unsat, portfolio.check());
+  EXPECT_NE(Portfolio::NO_WINNER, portfolio.winner());
+
+  record('A', encoders);
+  EXPECT_EQ(smt::sat, portfolio.check());
+  EXPECT_EQ(2, portfolio.win_count(0) + portfolio.win_count(1));
+}
@@ -0,0 +1,203 @@
+#include "concurrent.h"
+#include "concurrent/range.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+TEST(RangeTest, Join) {
+  const Range empty;
+  const Range x(Range::interval(-2, 3));
+  const Range y(Range::value(7));
+
+  EXPECT_TRUE(empty.is_empty());
+  EXPECT_EQ(x, empty.join(x));
+  EXPECT_EQ(x, x.join(empty));
+  EXPECT_EQ(Range::interval(-2, 7), x.join(y));
+  EXPECT_TRUE(x.join(Range::top()).is_top());
+}
+
+TEST(RangeTest, Arithmetic) {
+  const Range x(Range::interval(-2, 3));
+  const Range y(Range::interval(1, 4));
+
+  EXPECT_EQ(Range::interval(-1, 7), x.add(y));
+  EXPECT_EQ(Range::interval(-6, 2), x.sub(y));
+  EXPECT_EQ(Range::interval(-3, 2), x.neg());
+  EXPECT_TRUE(x.add(Range()).is_empty());
+
+  const Range max(Range::value(std::numeric_limits<long long>::max()));
+  EXPECT_TRUE(max.add(y).is_top());
+  EXPECT_TRUE(x.sub(Range::top()).is_top());
+}
+
+TEST(RangeTest, BitWidth) {
+  EXPECT_EQ(1, Range().bit_width(false));
+  EXPECT_EQ(1, Range::value(0).bit_width(false));
+  EXPECT_EQ(1, Range::value(1).bit_width(false));
+  EXPECT_EQ(2, Range::value(1).bit_width(true));
+  EXPECT_EQ(4, Range::interval(0, 9).bit_width(false));
+  EXPECT_EQ(5, Range::interval(0, 9).bit_width(true));
+  EXPECT_EQ(1, Range::value(-1).bit_width(true));
+  EXPECT_EQ(8, Range::interval(-128, 127).bit_width(true));
+  EXPECT_EQ(9, Range::interval(-129, 127).bit_width(true));
+  EXPECT_EQ(64, Range::interval(-1, 2).bit_width(false));
+}
+
+static void analyze(RangeAnalysis& analysis) {
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    analysis.add(*event_ptr);
+  }
+  analysis.solve();
+}
+
+TEST(RangeAnalysisTest, SharedVar) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  LocalVar<int> a;
+
+  x = 1;
+  x = 3;
+  a = x;
+
+  RangeAnalysis analysis;
+  analyze(analysis);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (!event_ptr->zone().is_bottom()) {
+      // signed values from 0 to 3
+      EXPECT_EQ(3, analysis.value_widths().at(event_ptr.get()));
+    }
+  }
+}
+
+TEST(RangeAnalysisTest, Arithmetic) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  LocalVar<int> a;
+  LocalVar<int> b;
+
+  a = 5;
+  b = a - 7;
+
+  RangeAnalysis analysis;
+  analyze(analysis);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (event_ptr->is_write()) {
+      EXPECT_FALSE(analysis.range(event_ptr.get()).is_top());
+    }
+  }
+}
+
+TEST(RangeAnalysisTest, UnsignedSubtraction) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<unsigned> x;
+  LocalVar<unsigned> a;
+
+  x = 0U;
+  x = 3U;
+
+  // x - 1U wraps around if x is zero
+  a = x - 1U;
+
+  RangeAnalysis analysis;
+  analyze(analysis);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  unsigned top_count = 0;
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (event_ptr->is_write() && event_ptr->zone().is_bottom() &&
+        analysis.range(event_ptr.get()).is_top()) {
+      top_count++;
+      EXPECT_EQ(0, analysis.value_widths().count(event_ptr.get()));
+    }
+  }
+
+  // the interval [-1, 2] of the difference is never narrowed to 2 bits
+  EXPECT_EQ(1, top_count);
+}
+
+TEST(RangeAnalysisTest, WidenGrowingValues) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+
+  // every write can be read by the others
+  x = x + 1;
+
+  RangeAnalysis analysis;
+  analyze(analysis);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (!event_ptr->zone().is_bottom()) {
+      EXPECT_TRUE(analysis.range(event_ptr.get()).is_top());
+      EXPECT_EQ(0, analysis.value_widths().count(event_ptr.get()));
+    }
+  }
+}
+
+TEST(RangeAnalysisTest, NondeterministicValue) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  LocalVar<int> a;
+  a = any<int>();
+
+  RangeAnalysis analysis;
+  analyze(analysis);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (event_ptr->is_read()) {
+      EXPECT_TRUE(analysis.range(event_ptr.get()).is_top());
+      EXPECT_EQ(0, analysis.value_widths().count(event_ptr.get()));
+    }
+  }
+}
+
+TEST(RangeAnalysisTest, Array) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int[10]> xs;
+  LocalVar<int> a;
+
+  xs[2] = 42;
+  a = xs[7];
+
+  RangeAnalysis analysis;
+  analyze(analysis);
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  unsigned array_count = 0;
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (analysis.index_widths().count(event_ptr.get()) != 0) {
+      array_count++;
+      EXPECT_EQ(8, analysis.index_widths().at(event_ptr.get()));
+      EXPECT_EQ(8, analysis.value_widths().at(event_ptr.get()));
+    }
+  }
+
+  // initialization, indirect write and read of the array
+  EXPECT_LE(2, array_count);
+}
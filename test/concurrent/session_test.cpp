@@ -0,0 +1,95 @@
+#include <thread>
+
+#include "concurrent.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+TEST(SessionTest, Scope) {
+  Session& default_session = Session::current();
+  Session session;
+
+  {
+    Session::Scope scope(session);
+    EXPECT_EQ(&session, &Session::current());
+  }
+
+  EXPECT_EQ(&default_session, &Session::current());
+}
+
+TEST(SessionTest, SeparateCounters) {
+  Session session;
+  Session other_session;
+
+  Session::Scope scope(session);
+  Event::reset_id(5);
+
+  {
+    Session::Scope other_scope(other_session);
+    const ReadEvent<char> other_event(0, Zone::unique_atom());
+    EXPECT_EQ(0, other_event.event_id());
+  }
+
+  const ReadEvent<char> event(0, Zone::unique_atom());
+  EXPECT_EQ(5, event.event_id());
+}
+
+TEST(SessionTest, SeparateThreads) {
+  Session session;
+  Session other_session;
+
+  {
+    Session::Scope scope(session);
+    Threads::reset();
+    Threads::begin_main_thread();
+  }
+
+  Session::Scope other_scope(other_session);
+  Threads::reset();
+  Threads::begin_main_thread();
+  EXPECT_EQ(0, ThisThread::thread_id());
+
+  Threads::begin_thread();
+  EXPECT_EQ(1, ThisThread::thread_id());
+  Threads::end_thread();
+}
+
+// x = 'A'; a = x; error(a == c)
+static smt::CheckResult check_session(char c) {
+  Session session;
+  Session::Scope scope(session);
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<char> x;
+  LocalVar<char> a;
+
+  x = 'A';
+  a = x;
+
+  Threads::error(a == c, session.encoders());
+  Threads::end_main_thread(session.encoders());
+
+  return session.encoders().solver.check();
+}
+
+TEST(SessionTest, ConcurrentAnalyses) {
+  smt::CheckResult sat_result = smt::unknown;
+  smt::CheckResult unsat_result = smt::unknown;
+
+  std::thread sat_thread([&sat_result]() {
+    sat_result = check_session('A');
+  });
+
+  std::thread unsat_thread([&unsat_result]() {
+    unsat_result = check_session('B');
+  });
+
+  sat_thread.join();
+  unsat_thread.join();
+
+  EXPECT_EQ(smt::sat, sat_result);
+  EXPECT_EQ(smt::unsat, unsat_result);
+}
@@ -77,3 +77,91 @@ TEST(SlicerTest, MaxSliceFreqThen) {
   EXPECT_FALSE(slicer.next_slice());
   EXPECT_EQ(2, slicer.slice_count());
 }
+
+TEST(SlicerTest, SplitUnexploredSlices) {
+  Slicer slicer(MAX_SLICE_FREQ);
+  Slicer other_slicer(MAX_SLICE_FREQ);
+
+  constexpr Location loc = __COUNTER__;
+  constexpr Location other_loc = __COUNTER__;
+  constexpr ThreadId thread_id = 3;
+  const Zone condition_zone = Zone::unique_atom();
+
+  std::unique_ptr<ReadEvent<bool>> condition_event_ptr(new ReadEvent<bool>(thread_id, condition_zone));
+  const std::shared_ptr<ReadInstr<bool>> condition_ptr(
+    new BasicReadInstr<bool>(std::move(condition_event_ptr)));
+
+  unsigned split_count = 0;
+  BranchPins split_pins;
+  slicer.set_split_fn([&split_count, &split_pins](const BranchPins& pins) {
+    split_count++;
+    split_pins = pins;
+    return true;
+  });
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  EXPECT_FALSE(slicer.begin_then_branch(loc, condition_ptr));
+  slicer.end_branch(loc);
+  EXPECT_FALSE(slicer.begin_then_branch(other_loc, condition_ptr));
+  slicer.end_branch(other_loc);
+
+  // the "then" side of loc is split off before other_loc is flipped
+  EXPECT_TRUE(slicer.next_slice());
+  EXPECT_EQ(1, split_count);
+  EXPECT_EQ(1, split_pins.size());
+  EXPECT_EQ(loc, split_pins.front().loc);
+  EXPECT_TRUE(split_pins.front().execute);
+  EXPECT_TRUE(split_pins.front().required);
+
+  EXPECT_EQ(1, slicer.pins().size());
+  EXPECT_FALSE(slicer.pins().front().execute);
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  EXPECT_FALSE(slicer.begin_then_branch(loc, condition_ptr));
+  slicer.end_branch(loc);
+  EXPECT_TRUE(slicer.begin_then_branch(other_loc, condition_ptr));
+  slicer.end_branch(other_loc);
+
+  EXPECT_TRUE(slicer.owns_slice());
+
+  // nothing is left to split off
+  EXPECT_FALSE(slicer.next_slice());
+  EXPECT_EQ(1, split_count);
+
+  // the other Slicer explores both sides of other_loc
+  other_slicer.restart(split_pins);
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  EXPECT_TRUE(other_slicer.begin_then_branch(loc, condition_ptr));
+  other_slicer.end_branch(loc);
+  EXPECT_FALSE(other_slicer.begin_then_branch(other_loc, condition_ptr));
+  other_slicer.end_branch(other_loc);
+
+  EXPECT_TRUE(other_slicer.owns_slice());
+  EXPECT_TRUE(other_slicer.next_slice());
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  EXPECT_TRUE(other_slicer.begin_then_branch(loc, condition_ptr));
+  other_slicer.end_branch(loc);
+  EXPECT_TRUE(other_slicer.begin_then_branch(other_loc, condition_ptr));
+  other_slicer.end_branch(other_loc);
+
+  EXPECT_TRUE(other_slicer.owns_slice());
+  EXPECT_FALSE(other_slicer.next_slice());
+
+  // slices that do not execute a required location belong to another Slicer
+  other_slicer.restart(split_pins);
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  EXPECT_FALSE(other_slicer.owns_slice());
+}
@@ -0,0 +1,147 @@
+#include <iterator>
+
+#include "concurrent.h"
+#include "gtest/gtest.h"
+
+using namespace se;
+using namespace se::ops;
+
+static size_t count_events() {
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  return std::distance(event_ptrs.cbegin(), event_ptrs.cend());
+}
+
+TEST(SummaryTest, Replay) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  auto increment = [&x](LocalVar<int>& a) {
+    x = x + a;
+    a = a + 1;
+  };
+
+  LocalVar<int> a(1);
+  const size_t begin_count = count_events();
+  increment(a);
+  const size_t call_count = count_events() - begin_count;
+
+  Summary<int> summary(increment);
+  EXPECT_EQ(0, summary.replay_count());
+
+  summary(a);
+  EXPECT_EQ(begin_count + 2 * call_count, count_events());
+  EXPECT_EQ(1, summary.replay_count());
+
+  summary(a);
+  EXPECT_EQ(begin_count + 3 * call_count, count_events());
+  EXPECT_EQ(2, summary.replay_count());
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    EXPECT_EQ(ThisThread::thread_id(), event_ptr->thread_id());
+  }
+}
+
+TEST(SummaryTest, RecordAgainAfterReset) {
+  Threads::reset();
+  const unsigned long long recording_id = Threads::recording_id();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  Summary<> increment([&x]() { x = x + 1; });
+  increment();
+
+  Threads::reset();
+  EXPECT_NE(recording_id, Threads::recording_id());
+  Threads::begin_main_thread();
+
+  const size_t begin_count = count_events();
+  increment();
+  EXPECT_LT(begin_count, count_events());
+  EXPECT_EQ(2, increment.replay_count());
+}
+
+// x = 0; a = 1; twice: x = x + a; a = a + 1
+static smt::CheckResult check_increment(int c) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  Summary<int> increment([&x](LocalVar<int>& a) {
+    x = x + a;
+    a = a + 1;
+  });
+
+  LocalVar<int> a(1);
+  increment(a);
+  increment(a);
+
+  Threads::error(x == c && a == 3, encoders);
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(SummaryTest, SatAndUnsat) {
+  EXPECT_EQ(smt::sat, check_increment(3));
+  EXPECT_EQ(smt::unsat, check_increment(2));
+}
+
+// top = n; twice: error(top == 0); top = top - 1
+static smt::CheckResult check_pop(int n) {
+  Encoders encoders;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> top(n);
+  Summary<> pop([&top, &encoders]() {
+    Threads::error(top == 0, encoders);
+    top = top - 1;
+  });
+
+  pop();
+  pop();
+
+  Threads::end_main_thread(encoders);
+
+  return encoders.check();
+}
+
+TEST(SummaryTest, ErrorConditions) {
+  EXPECT_EQ(smt::sat, check_pop(1));
+  EXPECT_EQ(smt::unsat, check_pop(2));
+}
+
+TEST(SummaryTest, Branch) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> x;
+  Summary<int> reset_if_negative([&x](LocalVar<int>& a) {
+    ThisThread::begin_then(a < 0);
+    x = 0;
+    ThisThread::end_branch();
+  });
+
+  LocalVar<int> a(-1);
+  reset_if_negative(a);
+  reset_if_negative(a);
+
+  // each replay has its own conditional block
+  std::shared_ptr<Block> block_ptr(ThisThread::most_outer_block_ptr());
+  unsigned conditional_block_count = 0;
+  for (const std::shared_ptr<Block>& inner_block_ptr :
+    block_ptr->inner_block_ptrs()) {
+
+    if (inner_block_ptr->condition_ptr()) {
+      conditional_block_count++;
+    }
+  }
+  EXPECT_EQ(2, conditional_block_count);
+}
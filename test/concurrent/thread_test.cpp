@@ -15,6 +15,10 @@ void f3(bool* function_call_ptr) {
   *function_call_ptr = true;
 }
 
+unsigned function_call_count;
+
+void f4() { function_call_count++; }
+
 TEST(ThreadTest, FunctionCallWithoutArgs) {
   function_call = false;
 
@@ -49,3 +53,22 @@ TEST(ThreadTest, FunctionCallWithPointerArgs) {
   Thread thread(f3, function_call_ptr);
   EXPECT_TRUE(function_call);
 }
+
+TEST(ThreadTest, CachedRecording) {
+  function_call_count = 0;
+
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  Thread t1(cached_recording, f4);
+  Thread t2(cached_recording, f4);
+  EXPECT_EQ(1, function_call_count);
+  EXPECT_NE(t1.thread_id(), t2.thread_id());
+
+  // every reset erases the cached recordings
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  Thread t3(cached_recording, f4);
+  EXPECT_EQ(2, function_call_count);
+}
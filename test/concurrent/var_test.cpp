@@ -1,5 +1,4 @@
-#include "concurrent/var.h"
-#include "concurrent/thread.h"
+#include "concurrent.h"
 #include "gtest/gtest.h"
 
 using namespace se;
@@ -108,3 +107,31 @@ TEST(VarTest, CopySharedVarToLocalVar) {
   EXPECT_NE(var.zone(), other.zone());
   EXPECT_TRUE(other.zone().is_bottom());
 }
+
+TEST(VarTest, FetchAdd) {
+  Threads::reset();
+  Threads::begin_main_thread();
+
+  SharedVar<int> var;
+  LocalVar<int> other;
+  other = var.fetch_add(2);
+
+  // the write event is paired with the read event of the operation
+  const Event& write_event = var.direct_write_event_ref();
+  const Event* const read_event_ptr = write_event.rmw_read_event_ptr();
+  ASSERT_NE(nullptr, read_event_ptr);
+  EXPECT_TRUE(read_event_ptr->is_read());
+  EXPECT_EQ(var.zone(), read_event_ptr->zone());
+  EXPECT_LT(read_event_ptr->event_id(), write_event.event_id());
+
+  std::forward_list<std::shared_ptr<Event>> event_ptrs;
+  Threads::filter(event_ptrs);
+
+  unsigned shared_read_count = 0;
+  for (const std::shared_ptr<Event>& event_ptr : event_ptrs) {
+    if (event_ptr->is_read() && !event_ptr->zone().is_bottom()) {
+      shared_read_count++;
+    }
+  }
+  EXPECT_EQ(1, shared_read_count);
+}